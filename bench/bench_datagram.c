@@ -0,0 +1,179 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+//
+// packet rate of the datagram transport on the loopback interface. sends are measured
+// one system call per datagram and corked (queued and sent in batches with sendmmsg, then
+// flushed); receives are batched with recvmmsg. with TS_DRIVER_STATS the system calls per
+// datagram are printed as well. datagrams the peer drops are reported, not retried.
+//
+// usage: bench_datagram [datagrams]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ts_platform.h"
+#include "ts_driver.h"
+#include "ts_driver_unix.h"
+#include "ts_bench.h"
+
+#define TS_BENCH_DATAGRAM 64    // bytes per datagram
+#define TS_BENCH_IDLE 200000    // microseconds without a datagram that end a receive
+#define TS_BENCH_BUFFER 4194304 // socket buffer bytes, to keep drops down
+
+static int _peer;
+static uint32_t _count;
+static uint32_t _received;
+
+// count the datagrams until none arrive for a while
+static void * _ts_bench_sink( void * state ) {
+
+	struct timeval timeout = { 0, TS_BENCH_IDLE };
+	setsockopt( _peer, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ));
+	uint8_t buffer[ TS_BENCH_DATAGRAM ];
+	_received = 0;
+	while( recv( _peer, buffer, sizeof( buffer ), 0 ) > 0 ) {
+		_received = _received + 1;
+	}
+	return NULL;
+}
+
+// send the datagrams to the driver
+static void * _ts_bench_source( void * state ) {
+
+	uint8_t buffer[ TS_BENCH_DATAGRAM ];
+	memset( buffer, 0x55, sizeof( buffer ));
+	for( uint32_t i = 0; i < _count; i++ ) {
+		while( send( _peer, buffer, sizeof( buffer ), 0 ) < 0 ) {
+			usleep( 10 );
+		}
+	}
+	return NULL;
+}
+
+static void _ts_bench_report( const char * name, TsDriverRef_t driver, uint32_t count, uint64_t elapsed, bool write ) {
+
+	printf( "%-24s %10.0f datagrams/sec, %u of %u received\n", name, count * 1e9 / elapsed, _received, count );
+#if defined(TS_DRIVER_STATS)
+	TsDriverUnixStats_t stats;
+	if( ts_driver_unix_stats( driver, &stats ) == TsStatusOk && count > 0 ) {
+		printf( "%-24s %.3f system calls per datagram\n", "",
+			(double) ( write ? stats._write_syscalls : stats._read_syscalls ) / count );
+	}
+#endif
+}
+
+static TsDriverRef_t _ts_bench_connect( char * address, bool cork ) {
+
+	TsDriverRef_t driver;
+	TsDriverUnixProfile_t profile;
+	memset( &profile, 0x00, sizeof( profile ));
+	profile._datagram = true;
+	profile._cork = cork;
+	profile._rcvbuf = TS_BENCH_BUFFER;
+	profile._sndbuf = TS_BENCH_BUFFER;
+	if( ts_driver->create( &driver ) != TsStatusOk ) {
+		return NULL;
+	}
+	if( ts_driver_unix_profile( driver, &profile ) != TsStatusOk || ts_driver->connect( driver, address ) != TsStatusOk ) {
+		ts_driver->destroy( driver );
+		return NULL;
+	}
+	ts_driver_unix_read_wait( driver, true );
+	return driver;
+}
+
+static void _ts_bench_send( const char * name, char * address, bool cork ) {
+
+	TsDriverRef_t driver = _ts_bench_connect( address, cork );
+	if( driver == NULL ) {
+		printf( "%s: cannot connect to %s\n", name, address );
+		return;
+	}
+	pthread_t sink;
+	pthread_create( &sink, NULL, _ts_bench_sink, NULL );
+
+	uint8_t buffer[ TS_BENCH_DATAGRAM ];
+	memset( buffer, 0x55, sizeof( buffer ));
+	uint64_t start = ts_bench_nsec();
+	for( uint32_t i = 0; i < _count; i++ ) {
+		size_t size = sizeof( buffer );
+		while( ts_driver->write( driver, buffer, &size, 0 ) == TsStatusOkWritePending ) {
+			size = sizeof( buffer );
+		}
+	}
+	while( ts_driver_unix_flush( driver ) == TsStatusOkWritePending ) {
+	}
+	uint64_t elapsed = ts_bench_nsec() - start;
+
+	pthread_join( sink, NULL );
+	_ts_bench_report( name, driver, _count, elapsed, true );
+	ts_driver->disconnect( driver );
+	ts_driver->destroy( driver );
+}
+
+static void _ts_bench_receive( const char * name, char * address ) {
+
+	TsDriverRef_t driver = _ts_bench_connect( address, false );
+	struct sockaddr_in local;
+	socklen_t length = sizeof( local );
+	if( driver == NULL || getsockname( ts_driver_unix_fd( driver ), (struct sockaddr *) &local, &length ) != 0 ||
+		connect( _peer, (struct sockaddr *) &local, length ) != 0 ) {
+		printf( "%s: cannot connect to %s\n", name, address );
+		return;
+	}
+	pthread_t source;
+	pthread_create( &source, NULL, _ts_bench_source, NULL );
+
+	uint8_t buffer[ TS_BENCH_DATAGRAM ];
+	uint64_t start = ts_bench_nsec();
+	uint64_t last = start;
+	_received = 0;
+	for( ;; ) {
+		size_t size = sizeof( buffer );
+		if( ts_driver->read( driver, buffer, &size, TS_BENCH_IDLE ) != TsStatusOk ) {
+			break;
+		}
+		_received = _received + 1;
+		last = ts_bench_nsec();
+	}
+
+	pthread_join( source, NULL );
+	_ts_bench_report( name, driver, _received, last - start, false );
+	ts_driver->disconnect( driver );
+	ts_driver->destroy( driver );
+}
+
+int main( int argc, char * argv[] ) {
+
+	_count = ts_bench_count( argc, argv, 1000000 );
+	ts_platform->initialize();
+
+	struct sockaddr_in peer;
+	socklen_t length = sizeof( peer );
+	memset( &peer, 0x00, sizeof( peer ));
+	peer.sin_family = AF_INET;
+	peer.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	int buffer = TS_BENCH_BUFFER;
+	_peer = socket( AF_INET, SOCK_DGRAM, 0 );
+	if( _peer < 0 ||
+		setsockopt( _peer, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof( buffer )) != 0 ||
+		bind( _peer, (struct sockaddr *) &peer, sizeof( peer )) != 0 ||
+		getsockname( _peer, (struct sockaddr *) &peer, &length ) != 0 ) {
+		printf( "cannot bind on the loopback interface\n" );
+		return 1;
+	}
+
+	char address[ 32 ];
+	snprintf( address, sizeof( address ), "127.0.0.1:%d", ntohs( peer.sin_port ));
+	_ts_bench_send( "send, unbatched", address, false );
+	_ts_bench_send( "send, corked", address, true );
+	_ts_bench_receive( "receive", address );
+
+	close( _peer );
+	return 0;
+}
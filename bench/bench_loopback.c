@@ -0,0 +1,147 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+//
+// round trip latency of small messages through the socket driver to an echo peer on the
+// loopback interface, with ts_driver_unix_read_wait (the read waits in poll for up to its
+// budget) and without (the caller retries a pending read after a short sleep, as callers
+// did before). with TS_DRIVER_STATS the system calls per round trip are printed as well.
+// bench_loopback_uring is built with the io_uring backend (TS_DRIVER_SOCKET_URING), its
+// system calls are the ring's, it falls back to the socket calls where the kernel lacks
+// support.
+//
+// usage: bench_loopback [round trips]
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ts_platform.h"
+#include "ts_driver.h"
+#include "ts_driver_unix.h"
+#include "ts_bench.h"
+
+#define TS_BENCH_MESSAGE 64     // bytes per message
+#define TS_BENCH_SLEEP 100      // microseconds between polling reads
+#define TS_BENCH_BUDGET 1000000 // microseconds
+
+static int _listener;
+
+// echo every message back, until the driver disconnects
+static void * _ts_bench_peer( void * state ) {
+
+	for( ;; ) {
+		int fd = accept( _listener, NULL, NULL );
+		if( fd < 0 ) {
+			return NULL;
+		}
+		int one = 1;
+		setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof( one ));
+		uint8_t buffer[ TS_BENCH_MESSAGE ];
+		ssize_t size;
+		while(( size = read( fd, buffer, sizeof( buffer ))) > 0 ) {
+			if( write( fd, buffer, (size_t) size ) != size ) {
+				break;
+			}
+		}
+		close( fd );
+	}
+}
+
+static bool _ts_bench_round_trip( TsDriverRef_t driver, bool wait ) {
+
+	uint8_t message[ TS_BENCH_MESSAGE ];
+	memset( message, 0x55, sizeof( message ));
+	size_t size = sizeof( message );
+	if( ts_driver->write( driver, message, &size, TS_BENCH_BUDGET ) != TsStatusOk || size != sizeof( message )) {
+		return false;
+	}
+
+	size_t received = 0;
+	while( received < sizeof( message )) {
+		size = sizeof( message ) - received;
+		TsStatus_t status = ts_driver->read( driver, message + received, &size, TS_BENCH_BUDGET );
+		if( status == TsStatusOkReadPending && !wait ) {
+			ts_platform_sleep( TS_BENCH_SLEEP );
+		} else if( status != TsStatusOk && status != TsStatusOkReadPending ) {
+			return false;
+		}
+		received = received + size;
+	}
+	return true;
+}
+
+static void _ts_bench_run( const char * name, char * address, bool wait, uint32_t count ) {
+
+	TsDriverRef_t driver;
+	TsDriverUnixProfile_t profile;
+	memset( &profile, 0x00, sizeof( profile ));
+	profile._nodelay = true;
+	if( ts_driver->create( &driver ) != TsStatusOk ||
+		ts_driver_unix_profile( driver, &profile ) != TsStatusOk ||
+		ts_driver->connect( driver, address ) != TsStatusOk ) {
+		printf( "%s: cannot connect to %s\n", name, address );
+		return;
+	}
+	ts_driver_unix_read_wait( driver, wait );
+#if defined(TS_DRIVER_STATS)
+	ts_driver_unix_stats_reset( driver );
+#endif
+
+	uint64_t * samples = (uint64_t *) malloc( count * sizeof( uint64_t ));
+	uint32_t completed = 0;
+	for( ; samples != NULL && completed < count; completed++ ) {
+		uint64_t start = ts_bench_nsec();
+		if( !_ts_bench_round_trip( driver, wait )) {
+			printf( "%s: round trip failed\n", name );
+			break;
+		}
+		samples[ completed ] = ts_bench_nsec() - start;
+	}
+	ts_bench_percentiles( name, samples, completed );
+
+#if defined(TS_DRIVER_STATS)
+	TsDriverUnixStats_t stats;
+	if( completed > 0 && ts_driver_unix_stats( driver, &stats ) == TsStatusOk ) {
+		printf( "%-24s %.2f read and %.2f write system calls per round trip\n", "",
+			(double) stats._read_syscalls / completed, (double) stats._write_syscalls / completed );
+	}
+#endif
+
+	free( samples );
+	ts_driver->disconnect( driver );
+	ts_driver->destroy( driver );
+}
+
+int main( int argc, char * argv[] ) {
+
+	uint32_t count = ts_bench_count( argc, argv, 20000 );
+	ts_platform->initialize();
+
+	struct sockaddr_in server;
+	socklen_t length = sizeof( server );
+	memset( &server, 0x00, sizeof( server ));
+	server.sin_family = AF_INET;
+	server.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	_listener = socket( AF_INET, SOCK_STREAM, 0 );
+	if( _listener < 0 ||
+		bind( _listener, (struct sockaddr *) &server, sizeof( server )) != 0 ||
+		listen( _listener, 1 ) != 0 ||
+		getsockname( _listener, (struct sockaddr *) &server, &length ) != 0 ) {
+		printf( "cannot listen on the loopback interface\n" );
+		return 1;
+	}
+	pthread_t peer;
+	pthread_create( &peer, NULL, _ts_bench_peer, NULL );
+
+	char address[ 32 ];
+	snprintf( address, sizeof( address ), "127.0.0.1:%d", ntohs( server.sin_port ));
+	_ts_bench_run( "polling", address, false, count );
+	_ts_bench_run( "read_wait", address, true, count );
+
+	return 0;
+}
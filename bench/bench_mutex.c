@@ -0,0 +1,129 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+//
+// throughput of read-mostly shared state, e.g., a firewall rule view, guarded by the
+// exclusive mutex and by the reader-writer lock. every thread reads the state under the
+// lock and, once per TS_BENCH_WRITES operations, updates it. the last line has the tick
+// threads skip, rather than wait for, a held mutex (ts_mutex_unix_trylock).
+//
+// usage: bench_mutex [operations per thread]
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "ts_platform.h"
+#include "ts_mutex.h"
+#include "ts_mutex_unix.h"
+#include "ts_bench.h"
+
+#define TS_BENCH_THREADS 4
+#define TS_BENCH_WRITES 100     // operations per write
+#define TS_BENCH_STATE 16       // words of shared state, read in full
+
+typedef enum TsBenchLock {
+	TsBenchLockExclusive,
+	TsBenchLockReaderWriter,
+	TsBenchLockTry,
+} TsBenchLock_t;
+
+static TsMutexRef_t _mutex;
+static TsRwlockRef_t _rwlock;
+static volatile uint32_t _state[ TS_BENCH_STATE ];
+
+typedef struct TsBenchThread {
+	TsBenchLock_t _lock;
+	uint32_t _operations;
+	uint32_t _skipped;
+	uint32_t _sum;
+} TsBenchThread_t;
+
+static bool _ts_bench_lock( TsBenchLock_t lock, bool write ) {
+
+	switch( lock ) {
+	case TsBenchLockExclusive:
+		return ts_mutex->lock( _mutex ) == TsStatusOk;
+	case TsBenchLockReaderWriter:
+		if( write ) {
+			return ts_mutex_unix_write_lock( _rwlock, TS_MUTEX_UNIX_FOREVER ) == TsStatusOk;
+		}
+		return ts_mutex_unix_read_lock( _rwlock, TS_MUTEX_UNIX_FOREVER ) == TsStatusOk;
+	case TsBenchLockTry:
+		if( write ) {
+			return ts_mutex->lock( _mutex ) == TsStatusOk;
+		}
+		return ts_mutex_unix_trylock( _mutex, 0 ) == TsStatusOk;
+	}
+	return false;
+}
+
+static void _ts_bench_unlock( TsBenchLock_t lock ) {
+
+	if( lock == TsBenchLockReaderWriter ) {
+		ts_mutex_unix_rwlock_unlock( _rwlock );
+	} else {
+		ts_mutex->unlock( _mutex );
+	}
+}
+
+static void * _ts_bench_thread( void * state ) {
+
+	TsBenchThread_t * thread = (TsBenchThread_t *) state;
+	for( uint32_t i = 0; i < thread->_operations; i++ ) {
+
+		bool write = ( i % TS_BENCH_WRITES ) == 0;
+		if( !_ts_bench_lock( thread->_lock, write )) {
+			thread->_skipped = thread->_skipped + 1;
+			continue;
+		}
+		for( int j = 0; j < TS_BENCH_STATE; j++ ) {
+			if( write ) {
+				_state[ j ] = _state[ j ] + 1;
+			} else {
+				thread->_sum = thread->_sum + _state[ j ];
+			}
+		}
+		_ts_bench_unlock( thread->_lock );
+	}
+	return NULL;
+}
+
+static void _ts_bench_run( const char * name, TsBenchLock_t lock, uint32_t operations ) {
+
+	pthread_t threads[ TS_BENCH_THREADS ];
+	TsBenchThread_t state[ TS_BENCH_THREADS ];
+	uint64_t start = ts_bench_nsec();
+	for( int i = 0; i < TS_BENCH_THREADS; i++ ) {
+		state[ i ]._lock = lock;
+		state[ i ]._operations = operations;
+		state[ i ]._skipped = 0;
+		state[ i ]._sum = 0;
+		pthread_create( &threads[ i ], NULL, _ts_bench_thread, &state[ i ] );
+	}
+	uint64_t skipped = 0;
+	for( int i = 0; i < TS_BENCH_THREADS; i++ ) {
+		pthread_join( threads[ i ], NULL );
+		skipped = skipped + state[ i ]._skipped;
+	}
+	uint64_t elapsed = ts_bench_nsec() - start;
+	double total = (double) operations * TS_BENCH_THREADS;
+	printf( "%-24s %d threads %10.2f M operations/sec, %llu skipped\n",
+		name, TS_BENCH_THREADS, total * 1000 / elapsed, (unsigned long long) skipped );
+}
+
+int main( int argc, char * argv[] ) {
+
+	uint32_t operations = ts_bench_count( argc, argv, 1000000 );
+	ts_platform->initialize();
+	if( ts_mutex->create( &_mutex ) != TsStatusOk || ts_mutex_unix_rwlock_create( &_rwlock ) != TsStatusOk ) {
+		printf( "cannot create the locks\n" );
+		return 1;
+	}
+
+	_ts_bench_run( "exclusive", TsBenchLockExclusive, operations );
+	_ts_bench_run( "reader-writer", TsBenchLockReaderWriter, operations );
+	_ts_bench_run( "exclusive, try to read", TsBenchLockTry, operations );
+
+	ts_mutex_unix_rwlock_destroy( _rwlock );
+	ts_mutex->destroy( _mutex );
+	return 0;
+}
@@ -0,0 +1,100 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+//
+// throughput of the random generator: a value at a time through ts_platform_random, and
+// in bulk through ts_platform_unix_random_fill, on one and on several threads. the first
+// line is the generator ts_random used before (srand and rand per value), for comparison.
+//
+// usage: bench_random [values]
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "ts_platform.h"
+#include "ts_platform_unix.h"
+#include "ts_bench.h"
+
+#define TS_BENCH_THREADS 4
+#define TS_BENCH_BULK 256       // values per fill
+
+static volatile uint32_t _sink;
+
+static void _ts_bench_srand( uint32_t * number ) {
+
+	srand( (int) ts_platform_time() );
+	*number = (uint32_t) rand();
+}
+
+static void _ts_bench_single( uint32_t values, void (*random)( uint32_t * )) {
+
+	uint32_t sum = 0;
+	for( uint32_t i = 0; i < values; i++ ) {
+		uint32_t number;
+		random( &number );
+		sum = sum + number;
+	}
+	_sink = sum;
+}
+
+static void _ts_bench_bulk( uint32_t values ) {
+
+	uint32_t numbers[ TS_BENCH_BULK ];
+	uint32_t sum = 0;
+	for( uint32_t i = 0; i < values; i = i + TS_BENCH_BULK ) {
+		ts_platform_unix_random_fill( numbers, sizeof( numbers ));
+		sum = sum + numbers[ 0 ];
+	}
+	_sink = sum;
+}
+
+typedef struct TsBenchRandom {
+	const char * _name;
+	void (*_random)( uint32_t * );  // NULL for bulk
+	uint32_t _values;
+} TsBenchRandom_t;
+
+static void * _ts_bench_thread( void * state ) {
+
+	TsBenchRandom_t * bench = (TsBenchRandom_t *) state;
+	if( bench->_random != NULL ) {
+		_ts_bench_single( bench->_values, bench->_random );
+	} else {
+		_ts_bench_bulk( bench->_values );
+	}
+	return NULL;
+}
+
+static void _ts_bench_run( TsBenchRandom_t * bench, int threads ) {
+
+	pthread_t thread[ TS_BENCH_THREADS ];
+	uint64_t start = ts_bench_nsec();
+	for( int i = 0; i < threads; i++ ) {
+		pthread_create( &thread[ i ], NULL, _ts_bench_thread, bench );
+	}
+	for( int i = 0; i < threads; i++ ) {
+		pthread_join( thread[ i ], NULL );
+	}
+	uint64_t elapsed = ts_bench_nsec() - start;
+	double total = (double) bench->_values * threads;
+	printf( "%-32s %d thread(s) %10.1f M values/sec %8.2f nsec/value/thread\n",
+		bench->_name, threads, total * 1000 / elapsed, elapsed / total * threads );
+}
+
+int main( int argc, char * argv[] ) {
+
+	uint32_t values = ts_bench_count( argc, argv, 10000000 );
+	ts_platform->initialize();
+
+	TsBenchRandom_t benches[] = {
+		{ "srand and rand (previous)", _ts_bench_srand, values / 10 },
+		{ "ts_platform_random", ts_platform->random, values },
+		{ "ts_platform_unix_random_fill", NULL, values },
+	};
+	for( size_t i = 0; i < sizeof( benches ) / sizeof( benches[ 0 ] ); i++ ) {
+		_ts_bench_run( &benches[ i ], 1 );
+		_ts_bench_run( &benches[ i ], TS_BENCH_THREADS );
+	}
+
+	return 0;
+}
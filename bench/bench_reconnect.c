@@ -0,0 +1,161 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+//
+// spread of reconnects after an outage. a number of drivers connect to a local listener,
+// which then resets every connection at once; the drivers reconnect from their ticks with
+// jittered backoff. prints the percentiles of the time to reconnect and the peak number
+// of connects within a TS_BENCH_WINDOW, which is the whole herd when in lockstep.
+//
+// usage: bench_reconnect [drivers]
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ts_platform.h"
+#include "ts_driver.h"
+#include "ts_driver_unix.h"
+#include "ts_bench.h"
+
+#define TS_BENCH_INITIAL 100000     // microseconds, the first backoff ceiling
+#define TS_BENCH_MAX 1000000        // microseconds, the backoff cap
+#define TS_BENCH_TIMEOUT 10000000   // microseconds to wait for the drivers to reconnect
+#define TS_BENCH_WINDOW 10000000    // nanoseconds
+
+typedef struct TsBenchDriver {
+	TsDriverRef_t _driver;
+	bool _lost;
+	uint64_t _reconnected;          // nanoseconds after the outage, zero until reconnected
+} TsBenchDriver_t;
+
+static uint64_t _outage;
+
+static void _ts_bench_state( TsDriverRef_t driver, void * state, TsDriverUnixState_t connection ) {
+
+	TsBenchDriver_t * bench = (TsBenchDriver_t *) state;
+	if( connection == TsDriverUnixStateBackoff ) {
+		bench->_lost = true;
+	} else if( connection == TsDriverUnixStateConnected && bench->_lost && bench->_reconnected == 0 ) {
+		bench->_reconnected = ts_bench_nsec() - _outage;
+	}
+}
+
+// accept what is pending, returns the number of connections accepted
+static uint32_t _ts_bench_accept( int listener, int * accepted, uint32_t count, uint32_t size ) {
+
+	int fd;
+	uint32_t start = count;
+	while( count < size && ( fd = accept( listener, NULL, NULL )) >= 0 ) {
+		accepted[ count ] = fd;
+		count = count + 1;
+	}
+	return count - start;
+}
+
+int main( int argc, char * argv[] ) {
+
+	uint32_t count = ts_bench_count( argc, argv, 256 );
+	ts_platform->initialize();
+
+	struct sockaddr_in server;
+	socklen_t length = sizeof( server );
+	memset( &server, 0x00, sizeof( server ));
+	server.sin_family = AF_INET;
+	server.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	int listener = socket( AF_INET, SOCK_STREAM, 0 );
+	if( listener < 0 ||
+		bind( listener, (struct sockaddr *) &server, sizeof( server )) != 0 ||
+		listen( listener, (int) count ) != 0 ||
+		getsockname( listener, (struct sockaddr *) &server, &length ) != 0 ||
+		fcntl( listener, F_SETFL, fcntl( listener, F_GETFL, 0 ) | O_NONBLOCK ) == -1 ) {
+		printf( "cannot listen on the loopback interface\n" );
+		return 1;
+	}
+	char address[ 32 ];
+	snprintf( address, sizeof( address ), "127.0.0.1:%d", ntohs( server.sin_port ));
+
+	TsBenchDriver_t * drivers = (TsBenchDriver_t *) calloc( count, sizeof( TsBenchDriver_t ));
+	int * accepted = (int *) malloc( 2 * count * sizeof( int ));
+	uint64_t * samples = (uint64_t *) malloc( count * sizeof( uint64_t ));
+	if( drivers == NULL || accepted == NULL || samples == NULL ) {
+		printf( "out of memory\n" );
+		return 1;
+	}
+
+	TsDriverUnixProfile_t profile;
+	memset( &profile, 0x00, sizeof( profile ));
+	profile._reconnect_initial = TS_BENCH_INITIAL;
+	profile._reconnect_max = TS_BENCH_MAX;
+	uint32_t connected = 0;
+	for( uint32_t i = 0; i < count; i++ ) {
+		if( ts_driver->create( &( drivers[ i ]._driver )) != TsStatusOk ||
+			ts_driver_unix_profile( drivers[ i ]._driver, &profile ) != TsStatusOk ||
+			ts_driver_unix_reconnect( drivers[ i ]._driver, _ts_bench_state, &drivers[ i ] ) != TsStatusOk ||
+			ts_driver->connect( drivers[ i ]._driver, address ) != TsStatusOk ) {
+			printf( "cannot connect driver %u to %s\n", i, address );
+			return 1;
+		}
+		connected = connected + _ts_bench_accept( listener, accepted, connected, count );
+	}
+	while( connected < count ) {
+		connected = connected + _ts_bench_accept( listener, accepted, connected, count );
+	}
+
+	// the outage, every connection is reset at once
+	_outage = ts_bench_nsec();
+	for( uint32_t i = 0; i < connected; i++ ) {
+		struct linger linger = { 1, 0 };
+		setsockopt( accepted[ i ], SOL_SOCKET, SO_LINGER, &linger, sizeof( linger ));
+		close( accepted[ i ] );
+	}
+	connected = 0;
+
+	// service the drivers, a read detects the loss and the tick reconnects
+	uint32_t reconnected = 0;
+	while( reconnected < count && ( ts_bench_nsec() - _outage ) / 1000 < TS_BENCH_TIMEOUT ) {
+		reconnected = 0;
+		for( uint32_t i = 0; i < count; i++ ) {
+			uint8_t buffer[ 16 ];
+			size_t size = sizeof( buffer );
+			ts_driver->read( drivers[ i ]._driver, buffer, &size, 0 );
+			ts_driver->tick( drivers[ i ]._driver, 0 );
+			reconnected = reconnected + ( drivers[ i ]._reconnected > 0 ? 1 : 0 );
+		}
+		connected = connected + _ts_bench_accept( listener, accepted, connected, 2 * count );
+	}
+
+	// the most connects within a window
+	uint32_t completed = 0;
+	for( uint32_t i = 0; i < count; i++ ) {
+		if( drivers[ i ]._reconnected > 0 ) {
+			samples[ completed ] = drivers[ i ]._reconnected;
+			completed = completed + 1;
+		}
+	}
+	ts_bench_percentiles( "time to reconnect", samples, completed );
+	uint32_t peak = 0;
+	for( uint32_t first = 0, last = 0; last < completed; last++ ) {
+		while( samples[ last ] - samples[ first ] >= TS_BENCH_WINDOW ) {
+			first = first + 1;
+		}
+		peak = ( last - first + 1 > peak ) ? last - first + 1 : peak;
+	}
+	printf( "%u of %u reconnected, at most %u within %u msec\n", completed, count, peak, TS_BENCH_WINDOW / 1000000 );
+
+	for( uint32_t i = 0; i < count; i++ ) {
+		ts_driver->disconnect( drivers[ i ]._driver );
+		ts_driver->destroy( drivers[ i ]._driver );
+	}
+	for( uint32_t i = 0; i < connected; i++ ) {
+		close( accepted[ i ] );
+	}
+	close( listener );
+	free( samples );
+	free( accepted );
+	free( drivers );
+	return 0;
+}
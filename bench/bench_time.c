@@ -0,0 +1,52 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+//
+// per-call cost of the clocks. ts_platform_time is read once per recv (and send) attempt
+// of the driver loops, the coarse variant is meant for those budget checks. the first
+// line is the clock ts_platform_time used before, for comparison.
+//
+// usage: bench_time [calls]
+
+#include <stdio.h>
+#include <time.h>
+
+#include "ts_platform.h"
+#include "ts_platform_unix.h"
+#include "ts_bench.h"
+
+static volatile uint64_t _sink;
+
+static uint64_t _ts_bench_realtime() {
+
+	struct timespec spec;
+	clock_gettime( CLOCK_REALTIME, &spec );
+	return (uint64_t) spec.tv_sec * 1000000 + (uint64_t) spec.tv_nsec / 1000;
+}
+
+static uint64_t _ts_bench_time() {
+	return ts_platform_time();
+}
+
+static void _ts_bench_clock( const char * name, uint64_t (*clock)(), uint32_t calls ) {
+
+	uint64_t sum = 0;
+	uint64_t start = ts_bench_nsec();
+	for( uint32_t i = 0; i < calls; i++ ) {
+		sum = sum + clock();
+	}
+	uint64_t elapsed = ts_bench_nsec() - start;
+	_sink = sum;
+	printf( "%-32s %8.1f nsec/call\n", name, (double) elapsed / calls );
+}
+
+int main( int argc, char * argv[] ) {
+
+	uint32_t calls = ts_bench_count( argc, argv, 10000000 );
+	ts_platform->initialize();
+
+	_ts_bench_clock( "clock_gettime(CLOCK_REALTIME)", _ts_bench_realtime, calls );
+	_ts_bench_clock( "ts_platform_time", _ts_bench_time, calls );
+	_ts_bench_clock( "ts_platform_unix_time_coarse", ts_platform_unix_time_coarse, calls );
+	_ts_bench_clock( "ts_platform_unix_wallclock", ts_platform_unix_wallclock, calls );
+
+	return 0;
+}
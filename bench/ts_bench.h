@@ -0,0 +1,55 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#ifndef TS_BENCH_H
+#define TS_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Return a monotonic time in nanoseconds, independent of the clocks being measured.
+ */
+static inline uint64_t ts_bench_nsec() {
+
+	struct timespec spec;
+	clock_gettime( CLOCK_MONOTONIC, &spec );
+	return (uint64_t) spec.tv_sec * 1000000000 + (uint64_t) spec.tv_nsec;
+}
+
+/**
+ * Return the count given as the first argument, or the default.
+ */
+static inline uint32_t ts_bench_count( int argc, char * argv[], uint32_t count ) {
+
+	if( argc > 1 && atol( argv[ 1 ] ) > 0 ) {
+		return (uint32_t) atol( argv[ 1 ] );
+	}
+	return count;
+}
+
+static int _ts_bench_compare( const void * left, const void * right ) {
+
+	uint64_t a = *(const uint64_t *) left;
+	uint64_t b = *(const uint64_t *) right;
+	return ( a > b ) - ( a < b );
+}
+
+/**
+ * Print the median, tail percentiles and maximum of the given samples (in nanoseconds) in
+ * microseconds. The samples are sorted in place.
+ */
+static inline void ts_bench_percentiles( const char * name, uint64_t * samples, uint32_t count ) {
+
+	if( count == 0 ) {
+		return;
+	}
+	qsort( samples, count, sizeof( uint64_t ), _ts_bench_compare );
+	printf( "%-24s p50 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f usec\n", name,
+		samples[ count / 2 ] / 1000.0,
+		samples[ (uint64_t) count * 99 / 100 ] / 1000.0,
+		samples[ (uint64_t) count * 999 / 1000 ] / 1000.0,
+		samples[ count - 1 ] / 1000.0 );
+}
+
+#endif // TS_BENCH_H
@@ -10,11 +10,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
 #include "ts_platform.h"
 #include "ts_driver.h"
+#include "ts_driver_unix.h"
 
 static TsStatus_t ts_create( TsDriverRef_t * );
 static TsStatus_t ts_destroy( TsDriverRef_t );
@@ -52,8 +54,53 @@ typedef struct TsDriverSerial {
 	struct termios _newtty;
 	uint64_t _last_read_timestamp;
 
+#if defined(TS_DRIVER_STATS)
+	TsDriverUnixStats_t _stats;
+#endif
+
 } TsDriverSerial_t;
 
+#if defined(TS_DRIVER_STATS)
+#define _ts_stats_count( serial, counter, value ) (( serial )->_stats.counter += ( value ))
+
+// bucket i counts calls that took less than 2^i microseconds (and at least 2^(i-1))
+static void _ts_stats_latency( uint64_t * histogram, uint64_t timestamp ) {
+
+	uint64_t elapsed = ts_platform_time() - timestamp;
+	int bucket = ( elapsed == 0 ) ? 0 : 64 - __builtin_clzll( elapsed );
+	if( bucket >= TS_DRIVER_UNIX_STATS_BUCKETS ) {
+		bucket = TS_DRIVER_UNIX_STATS_BUCKETS - 1;
+	}
+	histogram[ bucket ] = histogram[ bucket ] + 1;
+}
+
+static void _ts_stats_read( TsDriverSerialRef_t serial, uint64_t timestamp, size_t size, TsStatus_t status ) {
+
+	serial->_stats._reads = serial->_stats._reads + 1;
+	serial->_stats._bytes_in = serial->_stats._bytes_in + size;
+	if( status == TsStatusOkReadPending ) {
+		serial->_stats._read_pending = serial->_stats._read_pending + 1;
+	}
+	_ts_stats_latency( serial->_stats._read_latency, timestamp );
+}
+
+static void _ts_stats_write( TsDriverSerialRef_t serial, uint64_t timestamp, size_t size, size_t requested, TsStatus_t status ) {
+
+	serial->_stats._writes = serial->_stats._writes + 1;
+	serial->_stats._bytes_out = serial->_stats._bytes_out + size;
+	if( status == TsStatusOkWritePending ) {
+		serial->_stats._write_pending = serial->_stats._write_pending + 1;
+	} else if( size < requested ) {
+		serial->_stats._partial_writes = serial->_stats._partial_writes + 1;
+	}
+	_ts_stats_latency( serial->_stats._write_latency, timestamp );
+}
+#else
+#define _ts_stats_count( serial, counter, value )
+#define _ts_stats_read( serial, timestamp, size, status )
+#define _ts_stats_write( serial, timestamp, size, requested, status )
+#endif
+
 static TsStatus_t ts_create( TsDriverRef_t * driver ) {
 
 	TsDriverSerialRef_t serial = (TsDriverSerialRef_t) ( ts_platform_malloc( sizeof( TsDriverSerial_t )));
@@ -68,6 +115,9 @@ static TsStatus_t ts_create( TsDriverRef_t * driver ) {
 	snprintf( (char *)(serial->_driver._spec_id), TS_DRIVER_MAX_ID_SIZE, "%s", "B827EBA15910" );
 	serial->_fd = -1;
 	serial->_last_read_timestamp = 0;
+#if defined(TS_DRIVER_STATS)
+	memset( &( serial->_stats ), 0x00, sizeof( TsDriverUnixStats_t ));
+#endif
 
 	*driver = (TsDriverRef_t) serial;
 	return TsStatusOk;
@@ -112,7 +162,7 @@ static TsStatus_t ts_tick( TsDriverRef_t driver, uint32_t budget ) {
 			// do nothing, i.e., return ok
 			break;
 		}
-		ts_platform_free( buffer, buffer_size );
+		ts_platform_free( buffer, serial->_driver._spec_mcu );
 	}
 	return TsStatusOk;
 }
@@ -177,6 +227,8 @@ static TsStatus_t ts_connect( TsDriverRef_t driver, TsAddress_t address )  {
 
 	serial->_newtty = tty;
 
+	_ts_stats_count( serial, _reconnects, serial->_stats._connects > 0 ? 1 : 0 );
+	_ts_stats_count( serial, _connects, 1 );
 	return TsStatusOk;
 }
 
@@ -206,9 +258,14 @@ static TsStatus_t ts_read( TsDriverRef_t driver, const uint8_t * buffer, size_t
 	// just the number of reattempts by the caller,...
 	if( timestamp - serial->_last_read_timestamp == 0 ) {
 		*buffer_size = 0;
+		_ts_stats_read( serial, timestamp, 0, TsStatusOkReadPending );
 		return TsStatusOkReadPending;
 	}
 	serial->_last_read_timestamp = timestamp;
+#if defined(TS_DRIVER_STATS)
+	// the loop restarts timestamp per character, the latency is of the whole call
+	uint64_t started = timestamp;
+#endif
 
 	// perform read
 	int flags = 0x00;
@@ -222,6 +279,7 @@ static TsStatus_t ts_read( TsDriverRef_t driver, const uint8_t * buffer, size_t
 			ts_status_alarm("ts_driver_read: error from tcsetattr: %s (%d)\n", strerror(errno), errno );
 		}
 		ssize_t size = read( serial->_fd, (void*)(buffer + index), (*buffer_size) - index );
+		_ts_stats_count( serial, _read_syscalls, 1 );
 		if (tcsetattr(serial->_fd, TCSANOW, &(serial->_oldtty)) != 0) {
 			ts_status_alarm("ts_driver_read: error from tcsetattr: %s (%d)\n", strerror(errno), errno );
 		}
@@ -265,6 +323,7 @@ static TsStatus_t ts_read( TsDriverRef_t driver, const uint8_t * buffer, size_t
 
 	// update read buffer size and return
 	*buffer_size = index;
+	_ts_stats_read( serial, started, *buffer_size, status );
 	return status;
 }
 
@@ -302,6 +361,7 @@ static TsStatus_t ts_write( TsDriverRef_t driver, const uint8_t * buffer, size_t
 			ts_status_alarm("ts_driver_write: error from tcsetattr: %s (%d)\n", strerror(errno), errno );
 		}
 		ssize_t size = write( serial->_fd, buffer + index, *buffer_size - index );
+		_ts_stats_count( serial, _write_syscalls, 1 );
 		//tcdrain( serial->_fd );
 		if (tcsetattr(serial->_fd, TCSANOW, &(serial->_oldtty)) != 0) {
 			ts_status_alarm("ts_driver_write: error from tcsetattr: %s (%d)\n", strerror(errno), errno );
@@ -331,6 +391,7 @@ static TsStatus_t ts_write( TsDriverRef_t driver, const uint8_t * buffer, size_t
 
 			// there is more to write, but dont give control back to the caller
 			ts_status_debug( "ts_driver_write: ignoring timer budget exceeded\n");
+			_ts_stats_count( serial, _budget_overruns, 1 );
 		}
 
 		index = index + size;
@@ -345,9 +406,156 @@ static TsStatus_t ts_write( TsDriverRef_t driver, const uint8_t * buffer, size_t
 	} while( writing );
 
 	// update write buffer size and return
+	_ts_stats_write( serial, timestamp, (size_t) index, *buffer_size, status );
 	*buffer_size = (size_t) index;
 	return status;
 }
 
+// build a local vector for the part of the given vector that is still to be written,
+// i.e., skip the first offset bytes, resuming mid-element where needed
+static int _ts_iov_advance( const struct iovec * vector, int count, size_t offset, struct iovec * local ) {
+
+	int index = 0;
+	for( int i = 0; i < count && index < TS_DRIVER_UNIX_IOV_MAX; i++ ) {
+		if( offset >= vector[ i ].iov_len ) {
+			offset = offset - vector[ i ].iov_len;
+			continue;
+		}
+		local[ index ].iov_base = (uint8_t *) vector[ i ].iov_base + offset;
+		local[ index ].iov_len = vector[ i ].iov_len - offset;
+		offset = 0;
+		index = index + 1;
+	}
+	return index;
+}
+
+TsStatus_t ts_driver_unix_writev( TsDriverRef_t driver, const struct iovec * vector, int count, size_t * written, uint32_t budget ) {
+
+	ts_status_trace( "ts_driver_writev\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( vector != NULL );
+	ts_platform_assert( written != NULL );
+
+	TsDriverSerialRef_t serial = (TsDriverSerialRef_t) ( driver );
+
+	// initialize timestamp for write timer budgeting
+	uint64_t timestamp = ts_platform_time();
+
+	size_t total = 0;
+	for( int i = 0; i < count; i++ ) {
+		total = total + vector[ i ].iov_len;
+	}
+	if( *written >= total ) {
+		return TsStatusOk;
+	}
+
+	// perform write
+	bool writing = true;
+	size_t index = *written;
+	struct iovec local[ TS_DRIVER_UNIX_IOV_MAX ];
+	TsStatus_t status = TsStatusOk;
+	do {
+
+		// write to the port
+		if (tcsetattr(serial->_fd, TCSANOW, &(serial->_newtty)) != 0) {
+			ts_status_alarm("ts_driver_writev: error from tcsetattr: %s (%d)\n", strerror(errno), errno );
+		}
+		ssize_t size = writev( serial->_fd, local, _ts_iov_advance( vector, count, index, local ));
+		_ts_stats_count( serial, _write_syscalls, 1 );
+		if (tcsetattr(serial->_fd, TCSANOW, &(serial->_oldtty)) != 0) {
+			ts_status_alarm("ts_driver_writev: error from tcsetattr: %s (%d)\n", strerror(errno), errno );
+		}
+		if( size < 0 ) {
+
+			// write has indicated either non-block status
+			// or an actual driver issue,...
+			size = 0;
+			writing = false;
+
+			ts_status_debug( "ts_driver_writev: ignoring error, %s (%d)\n", strerror(errno), errno );
+			status = TsStatusErrorInternalServerError;
+
+		} else if( size == 0 ) {
+
+			// unexpected non-blocking call returns zero bytes
+			ts_status_info( "ts_driver_writev: unexpected empty write occured\n" );
+			writing = false;
+			if( index > *written ) {
+				status = TsStatusOk;
+			} else {
+				status = TsStatusOkWritePending;
+			}
+
+		} else if( ts_platform_time() - timestamp > budget ) {
+
+			// there is more to write, but dont give control back to the caller
+			ts_status_debug( "ts_driver_writev: ignoring timer budget exceeded\n" );
+			_ts_stats_count( serial, _budget_overruns, 1 );
+		}
+
+		index = index + (size_t) size;
+
+		if( index >= total ) {
+
+			// second normal exit condition, the vector is written
+			writing = false;
+			status = TsStatusOk;
+		}
+
+	} while( writing );
+
+	// update the written size and return
+	_ts_stats_write( serial, timestamp, index - *written, total - *written, status );
+	*written = index;
+	return status;
+}
+
+#if defined(TS_DRIVER_STATS)
+TsStatus_t ts_driver_unix_stats( TsDriverRef_t driver, TsDriverUnixStats_t * stats ) {
+
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( stats != NULL );
+
+	TsDriverSerialRef_t serial = (TsDriverSerialRef_t) ( driver );
+	*stats = serial->_stats;
+
+	return TsStatusOk;
+}
+
+TsStatus_t ts_driver_unix_stats_reset( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSerialRef_t serial = (TsDriverSerialRef_t) ( driver );
+	memset( &( serial->_stats ), 0x00, sizeof( TsDriverUnixStats_t ));
+
+	return TsStatusOk;
+}
+
+#endif
+
+TsStatus_t ts_driver_unix_flush( TsDriverRef_t driver ) {
+
+	ts_status_trace( "ts_driver_flush\n" );
+	ts_platform_assert( driver != NULL );
+
+	// writes are not batched on the port, just wait for them to leave
+	TsDriverSerialRef_t serial = (TsDriverSerialRef_t) ( driver );
+	if( serial->_fd >= 0 && tcdrain( serial->_fd ) != 0 ) {
+		ts_status_debug( "ts_driver_flush: error from tcdrain: %s (%d)\n", strerror(errno), errno );
+		return TsStatusErrorInternalServerError;
+	}
+
+	return TsStatusOk;
+}
+
+int ts_driver_unix_fd( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSerialRef_t serial = (TsDriverSerialRef_t) ( driver );
+	return serial->_fd;
+}
+
 #endif // __unix__
 #endif // TS_DRIVER_SERIAL
\ No newline at end of file
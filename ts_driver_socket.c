@@ -2,20 +2,49 @@
 #if defined(TS_DRIVER_SOCKET)
 #if defined(__unix__) || defined(__unix) || ( defined(__APPLE__) && defined(__MACH__))
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // for sendmmsg and recvmmsg
+#endif
+
 #include <arpa/inet.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <signal.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <sys/syscall.h> // for memfd_create
+#include <linux/errqueue.h>
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+#define TS_DRIVER_ZEROCOPY
+#endif
+#if defined(TS_DRIVER_SOCKET_URING)
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#endif
+#define TS_DRIVER_MMSG
+#endif
+
+// a stream send to a reset peer fails with EPIPE instead of raising SIGPIPE, where the
+// flag is missing SO_NOSIGPIPE is set on the socket, see _ts_apply_profile
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
 #if defined(__APPLE__) && defined(__MACH__)
 
 #include <sys/types.h>
@@ -27,6 +56,8 @@
 
 #include "ts_platform.h"
 #include "ts_driver.h"
+#include "ts_driver_unix.h"
+#include "ts_resolver.h"
 
 static uint8_t _hex_digits[] = { '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F' };
 
@@ -40,6 +71,31 @@ static TsStatus_t ts_read( TsDriverRef_t, const uint8_t *, size_t *, uint32_t );
 static TsStatus_t ts_reader( TsDriverRef_t, void *, TsDriverReader_t );
 static TsStatus_t ts_write( TsDriverRef_t, const uint8_t *, size_t *, uint32_t );
 
+#if defined(TS_DRIVER_SOCKET_URING)
+
+static TsStatus_t ts_create_uring( TsDriverRef_t * );
+static TsStatus_t ts_destroy_uring( TsDriverRef_t );
+static TsStatus_t ts_tick_uring( TsDriverRef_t, uint32_t );
+static TsStatus_t ts_connect_uring( TsDriverRef_t, TsAddress_t );
+static TsStatus_t ts_disconnect_uring( TsDriverRef_t );
+static TsStatus_t ts_read_uring( TsDriverRef_t, const uint8_t *, size_t *, uint32_t );
+static TsStatus_t ts_write_uring( TsDriverRef_t, const uint8_t *, size_t *, uint32_t );
+
+static TsDriverVtable_t ts_driver_unix_socket_uring = {
+	.create = ts_create_uring,
+	.destroy = ts_destroy_uring,
+	.tick = ts_tick_uring,
+
+	.connect = ts_connect_uring,
+	.disconnect = ts_disconnect_uring,
+	.read = ts_read_uring,
+	.reader = ts_reader,
+	.write = ts_write_uring,
+};
+const TsDriverVtable_t * ts_driver = &ts_driver_unix_socket_uring;
+
+#else
+
 static TsDriverVtable_t ts_driver_unix_socket = {
 	.create = ts_create,
 	.destroy = ts_destroy,
@@ -53,6 +109,8 @@ static TsDriverVtable_t ts_driver_unix_socket = {
 };
 const TsDriverVtable_t * ts_driver = &ts_driver_unix_socket;
 
+#endif
+
 typedef struct TsDriverSocket * TsDriverSocketRef_t;
 typedef struct TsDriverSocket {
 
@@ -63,349 +121,3183 @@ typedef struct TsDriverSocket {
 
 	int _fd;
 	uint64_t _last_read_timestamp;
+	uint8_t * _reader_buffer;
+	bool _read_wait;
+	uint32_t _connection;   // counts closed connections, see _ts_reader_deliver
+	TsDriverUnixProfile_t _unix_profile;
+
+	// receive ring, see ts_driver_unix_peek
+	uint8_t * _ring;
+	size_t _ring_size;
+	size_t _ring_head;      // first unread byte
+	size_t _ring_tail;      // end of the unread bytes
+	bool _ring_mirrored;    // the ring is mapped twice back to back
+
+	// zero-copy send, see ts_driver_unix_zerocopy
+	bool _zerocopy;                 // SO_ZEROCOPY is enabled on the socket
+	uint32_t _zerocopy_next;        // sequence of the next zero-copy send
+	uint32_t _zerocopy_done;        // sequences before this have been reported complete
+	TsDriverUnixCompletion_t _zerocopy_callback;
+	void * _zerocopy_state;
+
+	// datagram transport, see _datagram in TsDriverUnixProfile_t
+	bool _datagram;                 // connected with udp
+	uint8_t * _datagram_out;        // queued (corked) datagrams, a batch of mtu sized slots
+	size_t _datagram_out_size[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	int _datagram_out_count;
+	uint8_t * _datagram_in;         // received datagrams, a batch of mtu sized slots
+	size_t _datagram_in_size[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	int _datagram_in_head;
+	int _datagram_in_count;
+
+	// local (unix domain) connection, see ts_driver_unix_receive_fd
+	bool _local;
+	int _fds[ TS_DRIVER_UNIX_FD_MAX ];      // received descriptors not yet taken, oldest first
+	int _fds_count;
+
+	// connection state and reconnect, see ts_driver_unix_reconnect
+	TsDriverUnixState_t _state;
+	bool _reconnect;                // the profile enabled reconnecting at connect
+	char _address[ TS_ADDRESS_MAX_HOST_SIZE + TS_ADDRESS_MAX_PORT_SIZE ];   // of the last connect
+	struct addrinfo * _addresses;   // resolved at connect, the attempts try them in turn
+	uint32_t _attempts;             // failed attempts since the last connection
+	uint64_t _attempt_at;           // when the next attempt starts, or the current one started
+	TsDriverUnixStateCallback_t _reconnect_callback;
+	void * _reconnect_state;
+	uint8_t * _queue;               // writes held while reconnecting
+	size_t _queue_size;
+	size_t _queue_used;
+	bool _queue_paused;             // the callback is being told about the connection
+
+#if defined(TS_DRIVER_STATS)
+	TsDriverUnixStats_t _stats;
+#endif
+#if defined(TS_DRIVER_SOCKET_URING)
+	struct TsDriverUring * _uring;      // NULL when the kernel lacks support
+#endif
 
 } TsDriverSocket_t;
 
-static TsStatus_t ts_create( TsDriverRef_t * driver ) {
+#if defined(TS_DRIVER_SOCKET_URING)
+// while used, the io_uring backend owns the socket, see the end of the file
+static bool _ts_uring_used( TsDriverSocketRef_t );
+static int _ts_uring_fd( TsDriverSocketRef_t );
+static ssize_t _ts_uring_recv( TsDriverSocketRef_t, uint8_t *, size_t );
+static bool _ts_uring_wait( TsDriverSocketRef_t, uint64_t, uint32_t );
+static TsStatus_t _ts_uring_send( TsDriverSocketRef_t, const struct iovec *, int, size_t, size_t *, uint64_t, uint32_t );
+#endif
 
-	ts_status_trace( "ts_driver_create: socket\n" );
-	ts_platform_assert( driver != NULL );
+#if defined(TS_DRIVER_STATS)
+#define _ts_stats_count( sock, counter, value ) (( sock )->_stats.counter += ( value ))
 
-	// TODO - init sockets?
-	//sigignore(SIGHUP);
-	//sigignore(SIGINT);
-	//sigignore(SIGPIPE);
-	//sigignore(SIGALRM);
+// bucket i counts calls that took less than 2^i microseconds (and at least 2^(i-1))
+static void _ts_stats_latency( uint64_t * histogram, uint64_t timestamp ) {
 
-	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( ts_platform_malloc( sizeof( TsDriverSocket_t )));
-	sock->_driver._address = "";
-	sock->_driver._profile = NULL;
-	sock->_driver._spec_budget = 60*TS_TIME_SEC_TO_USEC;
-	sock->_driver._spec_mtu = 2048;
-	// TODO - should provide mac address here? probably not
-	// TODO - currently using my own mac-id - need to change this asap.
-	snprintf((char *) ( sock->_driver._spec_id ), TS_DRIVER_MAX_ID_SIZE, "%s", "B827EBA15910" );
-	sock->_fd = -1;
+	uint64_t elapsed = ts_platform_time() - timestamp;
+	int bucket = ( elapsed == 0 ) ? 0 : 64 - __builtin_clzll( elapsed );
+	if( bucket >= TS_DRIVER_UNIX_STATS_BUCKETS ) {
+		bucket = TS_DRIVER_UNIX_STATS_BUCKETS - 1;
+	}
+	histogram[ bucket ] = histogram[ bucket ] + 1;
+}
 
-	*driver = (TsDriverRef_t) sock;
+static void _ts_stats_read( TsDriverSocketRef_t sock, uint64_t timestamp, size_t size, TsStatus_t status ) {
 
-	return TsStatusOk;
+	sock->_stats._reads = sock->_stats._reads + 1;
+	sock->_stats._bytes_in = sock->_stats._bytes_in + size;
+	if( status == TsStatusOkReadPending ) {
+		sock->_stats._read_pending = sock->_stats._read_pending + 1;
+	}
+	_ts_stats_latency( sock->_stats._read_latency, timestamp );
 }
 
-static TsStatus_t ts_destroy( TsDriverRef_t driver ) {
+static void _ts_stats_write( TsDriverSocketRef_t sock, uint64_t timestamp, size_t size, size_t requested, TsStatus_t status ) {
 
-	ts_status_trace( "ts_driver_destroy\n" );
-	ts_platform_assert( driver != NULL );
+	sock->_stats._writes = sock->_stats._writes + 1;
+	sock->_stats._bytes_out = sock->_stats._bytes_out + size;
+	if( status == TsStatusOkWritePending ) {
+		sock->_stats._write_pending = sock->_stats._write_pending + 1;
+	} else if( size < requested ) {
+		sock->_stats._partial_writes = sock->_stats._partial_writes + 1;
+	}
+	_ts_stats_latency( sock->_stats._write_latency, timestamp );
+}
+#else
+#define _ts_stats_count( sock, counter, value )
+#define _ts_stats_read( sock, timestamp, size, status )
+#define _ts_stats_write( sock, timestamp, size, requested, status )
+#endif
 
-	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
-	ts_platform->free( sock, sizeof( TsDriverSocket_t ));
+/**
+ * Report the given (inclusive) range of zero-copy sends as complete, their buffers
+ * may be reused.
+ */
+static void _ts_zerocopy_complete( TsDriverSocketRef_t sock, uint32_t first, uint32_t last ) {
 
-	return TsStatusOk;
+	if( (int32_t) ( last + 1 - sock->_zerocopy_done ) > 0 ) {
+		sock->_zerocopy_done = last + 1;
+	}
+	if( sock->_zerocopy_callback != NULL ) {
+		sock->_zerocopy_callback( (TsDriverRef_t) sock, sock->_zerocopy_state, first, last );
+	}
 }
 
-static TsStatus_t ts_tick( TsDriverRef_t driver, uint32_t budget ) {
+/**
+ * Collect the zero-copy completions queued on the socket's error queue.
+ */
+static void _ts_zerocopy_reap( TsDriverSocketRef_t sock ) {
+
+#if defined(TS_DRIVER_ZEROCOPY)
+	while( sock->_zerocopy_done != sock->_zerocopy_next ) {
+
+		char control[ 128 ];
+		struct msghdr message;
+		memset( &message, 0x00, sizeof( message ));
+		message.msg_control = control;
+		message.msg_controllen = sizeof( control );
+		if( recvmsg( sock->_fd, &message, MSG_ERRQUEUE ) < 0 ) {
+			if( errno != EWOULDBLOCK && errno != EAGAIN && errno != EINTR ) {
+				ts_status_debug( "ts_driver_zerocopy: ignoring error, %d\n", errno );
+			}
+			break;
+		}
+		for( struct cmsghdr * header = CMSG_FIRSTHDR( &message ); header != NULL; header = CMSG_NXTHDR( &message, header )) {
+			if( !( header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR ) &&
+				!( header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR )) {
+				continue;
+			}
+			struct sock_extended_err * error = (struct sock_extended_err *) CMSG_DATA( header );
+			if( error->ee_errno == 0 && error->ee_origin == SO_EE_ORIGIN_ZEROCOPY ) {
+				// note, SO_EE_CODE_ZEROCOPY_COPIED in ee_code means the kernel copied after all
+				_ts_zerocopy_complete( sock, error->ee_info, error->ee_data );
+			}
+		}
+	}
+#endif
+}
 
-	ts_status_trace( "ts_driver_tick\n" );
-	ts_platform_assert( driver != NULL );
+/**
+ * Send the given message, with MSG_ZEROCOPY when enabled and the remaining data reaches
+ * the profile threshold. The pages stay pinned until the completion is reaped.
+ */
+static ssize_t _ts_sendmsg( TsDriverSocketRef_t sock, const struct msghdr * message, size_t remaining, int flags ) {
+
+#if defined(TS_DRIVER_ZEROCOPY)
+	if( sock->_zerocopy && remaining >= sock->_unix_profile._zerocopy_threshold ) {
+		ssize_t size = sendmsg( sock->_fd, message, flags | MSG_NOSIGNAL | MSG_ZEROCOPY );
+		if( size > 0 ) {
+			sock->_zerocopy_next = sock->_zerocopy_next + 1;
+			return size;
+		}
+		if( size == 0 || errno != ENOBUFS ) {
+			return size;
+		}
+		// out of memory to pin pages, copy this one
+	}
+#endif
+	return sendmsg( sock->_fd, message, flags | MSG_NOSIGNAL );
+}
 
-	// do nothing
+/**
+ * Queue the descriptors passed with a received message, closing those that do not fit.
+ */
+static void _ts_fds_collect( TsDriverSocketRef_t sock, struct msghdr * message ) {
 
-	return TsStatusOk;
+	if( message->msg_flags & MSG_CTRUNC ) {
+		ts_status_debug( "ts_driver_read: passed descriptors dropped\n" );
+	}
+	for( struct cmsghdr * header = CMSG_FIRSTHDR( message ); header != NULL; header = CMSG_NXTHDR( message, header )) {
+		if( header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS ) {
+			continue;
+		}
+		size_t count = ( header->cmsg_len - CMSG_LEN( 0 )) / sizeof( int );
+		for( size_t i = 0; i < count; i++ ) {
+			int fd;
+			memcpy( &fd, CMSG_DATA( header ) + i * sizeof( int ), sizeof( int ));
+			if( sock->_fds_count < TS_DRIVER_UNIX_FD_MAX ) {
+				sock->_fds[ sock->_fds_count ] = fd;
+				sock->_fds_count = sock->_fds_count + 1;
+			} else {
+				ts_status_debug( "ts_driver_read: too many passed descriptors, closing %d\n", fd );
+				close( fd );
+			}
+		}
+	}
 }
 
-static TsStatus_t ts_connect( TsDriverRef_t driver, TsAddress_t address ) {
-
-	ts_status_trace( "ts_driver_connect\n" );
-	ts_platform_assert( driver != NULL );
+/**
+ * Receive from the socket. On a local connection the descriptors passed along with the data
+ * are kept for ts_driver_unix_receive_fd, a plain recv would close them.
+ */
+static ssize_t _ts_recv( TsDriverSocketRef_t sock, void * buffer, size_t size, int flags ) {
 
-	TsStatus_t status = TsStatusErrorNotFound;
-	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+#if defined(TS_DRIVER_SOCKET_URING)
+	if( _ts_uring_used( sock )) {
+		// the multishot receive drains the socket, take what it collected
+		return _ts_uring_recv( sock, (uint8_t *) buffer, size );
+	}
+#endif
+	if( !sock->_local ) {
+		return recv( sock->_fd, buffer, size, flags );
+	}
 
-	// TODO - should really pattern match to see if this is an IP or an FQDN
-#if defined(TS_UNIX_SIMPLE_SOCKET)
-	struct sockaddr_in server;
-	sock->_fd = socket(AF_INET, SOCK_STREAM , 0);
-	if( sock->_fd == -1 ) {
-		return TsStatusErrorInternalServerError;
+	union {
+		char buffer[ CMSG_SPACE( TS_DRIVER_UNIX_FD_MAX * sizeof( int )) ];
+		struct cmsghdr align;
+	} control;
+	struct iovec vector;
+	vector.iov_base = buffer;
+	vector.iov_len = size;
+	struct msghdr message;
+	memset( &message, 0x00, sizeof( message ));
+	message.msg_iov = &vector;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof( control.buffer );
+#if defined(MSG_CMSG_CLOEXEC)
+	flags = flags | MSG_CMSG_CLOEXEC;
+#endif
+	ssize_t received = recvmsg( sock->_fd, &message, flags );
+	if( received > 0 ) {
+		_ts_fds_collect( sock, &message );
 	}
+	return received;
+}
 
-	char host[256], port[8];
-	ts_address_parse( address, host, port );
+// datagram transport
+//
+// a connected udp socket. datagrams are received a batch at a time into mtu sized
+// slots and handed out one per read (or reader call), so message boundaries are kept.
+// corked writes are copied into a queue of mtu sized slots and sent a batch at a time.
+// sendmmsg and recvmmsg are linux only, elsewhere a batch takes a system call per
+// datagram.
 
-	server.sin_addr.s_addr = inet_addr( host );
-	server.sin_family = AF_INET;
-	server.sin_port = htons( atoi( port ) );
+static bool _ts_read_wait( TsDriverSocketRef_t, uint64_t, uint32_t );
 
-	if (connect( sock->_fd , (struct sockaddr *)&server , sizeof(server)) == 0) {
+static TsStatus_t _ts_datagram_status( const char * label, TsStatus_t pending ) {
 
-		if( fcntl( sock->_fd, F_SETFL, fcntl( sock->_fd, F_GETFL, 0 ) | O_NONBLOCK ) == -1 ) {
+	if( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) {
+		return pending;
+	}
+	if( errno == ECONNREFUSED || errno == EPIPE || errno == ECONNRESET ) {
+		// nothing listening at the peer, reported by icmp
+		return TsStatusErrorConnectionReset;
+	}
+	ts_status_debug( "%s: ignoring error, %d\n", label, errno );
+	return TsStatusErrorInternalServerError;
+}
 
-			status = TsStatusErrorInternalServerError;
+/**
+ * Receive up to a batch of datagrams into the (empty) receive queue. Returns the number
+ * queued, empty datagrams are dropped, or -1 with errno set. On a local connection the
+ * descriptors passed with the batch are kept for ts_driver_unix_receive_fd (those of an
+ * empty datagram included), a receive without control buffers would close them.
+ */
+static int _ts_datagram_receive( TsDriverSocketRef_t sock ) {
+
+	size_t mtu = sock->_driver._spec_mtu;
+	if( sock->_datagram_in == NULL ) {
+		sock->_datagram_in = (uint8_t *) ts_platform_malloc( TS_DRIVER_UNIX_DATAGRAM_BATCH * mtu );
+		if( sock->_datagram_in == NULL ) {
+			errno = ENOMEM;
+			return -1;
+		}
+	}
 
-		} else {
+	struct iovec vectors[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	int flags[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	for( int i = 0; i < TS_DRIVER_UNIX_DATAGRAM_BATCH; i++ ) {
+		vectors[ i ].iov_base = sock->_datagram_in + (size_t) i * mtu;
+		vectors[ i ].iov_len = mtu;
+	}
+	union {
+		char buffer[ CMSG_SPACE( TS_DRIVER_UNIX_FD_MAX * sizeof( int )) ];
+		struct cmsghdr align;
+	} controls[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	int receive = 0;
+#if defined(MSG_CMSG_CLOEXEC)
+	receive = MSG_CMSG_CLOEXEC;
+#endif
 
-			status = TsStatusOk;
+	int count = 0;
+#if defined(TS_DRIVER_MMSG)
+	struct mmsghdr messages[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	memset( messages, 0x00, sizeof( messages ));
+	for( int i = 0; i < TS_DRIVER_UNIX_DATAGRAM_BATCH; i++ ) {
+		messages[ i ].msg_hdr.msg_iov = &( vectors[ i ] );
+		messages[ i ].msg_hdr.msg_iovlen = 1;
+		if( sock->_local ) {
+			messages[ i ].msg_hdr.msg_control = controls[ i ].buffer;
+			messages[ i ].msg_hdr.msg_controllen = sizeof( controls[ i ].buffer );
+		}
+	}
+	count = recvmmsg( sock->_fd, messages, TS_DRIVER_UNIX_DATAGRAM_BATCH, sock->_local ? receive : 0, NULL );
+	_ts_stats_count( sock, _read_syscalls, 1 );
+	if( count < 0 ) {
+		return -1;
+	}
+	for( int i = 0; i < count; i++ ) {
+		sock->_datagram_in_size[ i ] = messages[ i ].msg_len;
+		flags[ i ] = messages[ i ].msg_hdr.msg_flags;
+		if( sock->_local ) {
+			_ts_fds_collect( sock, &( messages[ i ].msg_hdr ));
 		}
 	}
 #else
-	// init address hints
-	struct addrinfo hints;
-	memset( &hints, 0x00, sizeof( struct addrinfo ));
-	hints.ai_family = AF_UNSPEC;
-	// TODO - allow UDP
-	hints.ai_socktype = SOCK_STREAM;
-	hints.ai_protocol = IPPROTO_TCP;
-
-	// decode and resolve address
-	char host[TS_ADDRESS_MAX_HOST_SIZE];
-	char port[TS_ADDRESS_MAX_PORT_SIZE];
-	if( ts_address_parse( address, host, port ) != TsStatusOk ) {
-		return TsStatusErrorInternalServerError;
+	for( ; count < TS_DRIVER_UNIX_DATAGRAM_BATCH; count++ ) {
+		struct msghdr message;
+		memset( &message, 0x00, sizeof( message ));
+		message.msg_iov = &( vectors[ count ] );
+		message.msg_iovlen = 1;
+		if( sock->_local ) {
+			message.msg_control = controls[ count ].buffer;
+			message.msg_controllen = sizeof( controls[ count ].buffer );
+		}
+		ssize_t size = recvmsg( sock->_fd, &message, sock->_local ? receive : 0 );
+		_ts_stats_count( sock, _read_syscalls, 1 );
+		if( size < 0 ) {
+			break;
+		}
+		sock->_datagram_in_size[ count ] = (size_t) size;
+		flags[ count ] = message.msg_flags;
+		if( sock->_local ) {
+			_ts_fds_collect( sock, &message );
+		}
 	}
-	struct addrinfo * address_list;
-	if( getaddrinfo( host, port, &hints, &address_list ) != 0 ) {
-		return TsStatusErrorNotFound;
+	if( count == 0 ) {
+		return -1;
 	}
+#endif
 
-	// find active listener
-	struct addrinfo * current;
-	for( current = address_list; current != NULL; current = current->ai_next ) {
-
-		sock->_fd = (int) socket( current->ai_family, current->ai_socktype, current->ai_protocol );
-		if( sock->_fd < 0 ) {
-			status = TsStatusErrorNotFound;
+	int queued = 0;
+	for( int i = 0; i < count; i++ ) {
+		if( flags[ i ] & MSG_TRUNC ) {
+			ts_status_debug( "ts_driver_read: datagram truncated to the mtu\n" );
+		}
+		if( sock->_datagram_in_size[ i ] == 0 ) {
 			continue;
 		}
-		if( connect( sock->_fd, current->ai_addr, current->ai_addrlen ) == 0 ) {
+		if( queued != i ) {
+			memmove( sock->_datagram_in + (size_t) queued * mtu, sock->_datagram_in + (size_t) i * mtu, sock->_datagram_in_size[ i ] );
+			sock->_datagram_in_size[ queued ] = sock->_datagram_in_size[ i ];
+		}
+		queued = queued + 1;
+	}
+	sock->_datagram_in_head = 0;
+	sock->_datagram_in_count = queued;
+	return queued;
+}
 
-			if( fcntl( sock->_fd, F_SETFL, fcntl( sock->_fd, F_GETFL, 0 ) | O_NONBLOCK ) == -1 ) {
-				status = TsStatusErrorInternalServerError;
-				close( sock->_fd );
-				continue;
-			}
-			status = TsStatusOk;
+/**
+ * Take the next received datagram off the receive queue, valid until the next receive.
+ */
+static size_t _ts_datagram_next( TsDriverSocketRef_t sock, const uint8_t ** data ) {
+
+	int index = sock->_datagram_in_head;
+	*data = sock->_datagram_in + (size_t) index * sock->_driver._spec_mtu;
+	sock->_datagram_in_head = index + 1;
+	sock->_datagram_in_count = sock->_datagram_in_count - 1;
+	return sock->_datagram_in_size[ index ];
+}
+
+/**
+ * Send the first count queued datagrams. Returns the number sent, or -1 with errno set
+ * when none was.
+ */
+static int _ts_datagram_send( TsDriverSocketRef_t sock, int count ) {
+
+	size_t mtu = sock->_driver._spec_mtu;
+	struct iovec vectors[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	for( int i = 0; i < count; i++ ) {
+		vectors[ i ].iov_base = sock->_datagram_out + (size_t) i * mtu;
+		vectors[ i ].iov_len = sock->_datagram_out_size[ i ];
+	}
+
+#if defined(TS_DRIVER_MMSG)
+	struct mmsghdr messages[ TS_DRIVER_UNIX_DATAGRAM_BATCH ];
+	memset( messages, 0x00, sizeof( messages ));
+	for( int i = 0; i < count; i++ ) {
+		messages[ i ].msg_hdr.msg_iov = &( vectors[ i ] );
+		messages[ i ].msg_hdr.msg_iovlen = 1;
+	}
+	int sent = sendmmsg( sock->_fd, messages, (unsigned int) count, MSG_NOSIGNAL );
+	_ts_stats_count( sock, _write_syscalls, 1 );
+	return sent;
+#else
+	int sent = 0;
+	for( ; sent < count; sent++ ) {
+		struct msghdr message;
+		memset( &message, 0x00, sizeof( message ));
+		message.msg_iov = &( vectors[ sent ] );
+		message.msg_iovlen = 1;
+		_ts_stats_count( sock, _write_syscalls, 1 );
+		if( sendmsg( sock->_fd, &message, MSG_NOSIGNAL ) < 0 ) {
 			break;
 		}
-		status = TsStatusErrorBadGateway;
-		ts_disconnect( driver );
 	}
-	freeaddrinfo( address_list );
+	return ( sent == 0 ) ? -1 : sent;
 #endif
-
-	// return status
-	return status;
 }
 
-static TsStatus_t ts_disconnect( TsDriverRef_t driver ) {
+/**
+ * Send the queued datagrams, a batch per system call. When the socket would block the rest
+ * stay queued; a datagram that fails otherwise is dropped, so it cannot block the queue.
+ */
+static TsStatus_t _ts_datagram_flush( TsDriverSocketRef_t sock ) {
 
-	ts_status_trace( "ts_driver_disconnect\n" );
-	ts_platform_assert( driver != NULL );
+	size_t mtu = sock->_driver._spec_mtu;
+	TsStatus_t status = TsStatusOk;
+	while( sock->_datagram_out_count > 0 && status == TsStatusOk ) {
 
-	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
-	close( sock->_fd );
+		int sent = _ts_datagram_send( sock, sock->_datagram_out_count );
+		if( sent < 0 ) {
+			if( errno == EINTR ) {
+				continue;
+			}
+			status = _ts_datagram_status( "ts_driver_flush", TsStatusOkWritePending );
+			if( status == TsStatusOkWritePending ) {
+				break;
+			}
+			sent = 1;
+		}
 
-	return TsStatusOk;
+		// move the rest to the front of the queue
+		int remaining = sock->_datagram_out_count - sent;
+		if( remaining > 0 ) {
+			memmove( sock->_datagram_out, sock->_datagram_out + (size_t) sent * mtu, (size_t) remaining * mtu );
+			memmove( sock->_datagram_out_size, sock->_datagram_out_size + sent, (size_t) remaining * sizeof( size_t ));
+		}
+		sock->_datagram_out_count = remaining;
+	}
+	return status;
 }
 
 /**
- * Read from the socket driver (non-blocking). Note that we dont use select() in order to emulate
- * the other channels better, e.g., uart and usb.
- *
- * @note
- * TsStatusOkReadPending has a very specific meaning, only return when the read
- * has returned pending and there isn't data in the buffer, in all other cases
- * return a valid status with the contents of the current buffer.
- *
- * @param driver
- * [in] The socket state
- *
- * @param buffer
- * [in] The pre-allocated buffer memory
- *
- * @param buffer_size
- * [in] The pre-allocated buffer memory size
- * [out] The actual number of byte read
- *
- * @param budget
- * [in] Recommended allotment of time in microseconds allowed wait for received bytes.
- *
- * @return
- * TsStatusOk, *buffer_size > 0 - Return the given amount of read data
- * TsStatusOk, *buffer_size = 0 - Usually indicates and end-of-file condition
- * TsStatusOkPendingRead        - Indicates a blocking condition exists (and avoided),
- *                                note, *buffer_size is guaranteed to be zero when this condition occurs.
- *                                TODO - currently, we dont wait for the budget to be exhausted, this may change later
- * TsStatusErrorConnectionReset - Indicates that the driver was broken
- * TsStatusError*               - Indicates an error has occurred, see ts_status.h for more information.
+ * Send the given vector as one datagram or, when corked and it fits a slot, queue a copy
+ * of it. Queued datagrams are sent first, so the order is kept.
  */
-static TsStatus_t ts_read( TsDriverRef_t driver, const uint8_t * buffer, size_t * buffer_size, uint32_t budget ) {
-
-	ts_status_trace( "ts_driver_read\n" );
-	ts_platform_assert( driver != NULL );
-	ts_platform_assert( buffer != NULL );
-	ts_platform_assert( buffer_size != NULL );
-	ts_platform_assert( *buffer_size > 0 );
+static TsStatus_t _ts_datagram_write( TsDriverSocketRef_t sock, const struct iovec * vector, int count, size_t size ) {
 
-	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	size_t mtu = sock->_driver._spec_mtu;
+	TsStatus_t status = TsStatusOk;
 
-	// initialize timestamp for read timer budgeting
-	uint64_t timestamp = ts_platform_time();
+	if( sock->_unix_profile._cork && size <= mtu ) {
 
-	// limit read to 1MHz call bandwidth
-	// note that this doesnt limit the number of recv calls made below,
-	// just the number of reattempts by the caller,...
-	if( timestamp - sock->_last_read_timestamp == 0 ) {
-		*buffer_size = 0;
-		return TsStatusOkReadPending;
+		if( sock->_datagram_out == NULL ) {
+			sock->_datagram_out = (uint8_t *) ts_platform_malloc( TS_DRIVER_UNIX_DATAGRAM_BATCH * mtu );
+			if( sock->_datagram_out == NULL ) {
+				return TsStatusErrorInternalServerError;
+			}
+		}
+		if( sock->_datagram_out_count == TS_DRIVER_UNIX_DATAGRAM_BATCH ) {
+			status = _ts_datagram_flush( sock );
+			if( status != TsStatusOk ) {
+				return status;
+			}
+		}
+		uint8_t * slot = sock->_datagram_out + (size_t) sock->_datagram_out_count * mtu;
+		for( int i = 0; i < count; i++ ) {
+			memcpy( slot, vector[ i ].iov_base, vector[ i ].iov_len );
+			slot = slot + vector[ i ].iov_len;
+		}
+		sock->_datagram_out_size[ sock->_datagram_out_count ] = size;
+		sock->_datagram_out_count = sock->_datagram_out_count + 1;
+		return TsStatusOk;
 	}
-	sock->_last_read_timestamp = timestamp;
 
-	// perform read
-	int flags = 0x00;
-	bool reading = true;
-	ssize_t index = 0;
-	TsStatus_t status = TsStatusOk;
+	if( sock->_datagram_out_count > 0 ) {
+		status = _ts_datagram_flush( sock );
+		if( status != TsStatusOk ) {
+			return status;
+		}
+	}
+	struct msghdr message;
+	memset( &message, 0x00, sizeof( message ));
+	message.msg_iov = (struct iovec *) vector;
+	message.msg_iovlen = count;
 	do {
+		_ts_stats_count( sock, _write_syscalls, 1 );
+		if( _ts_sendmsg( sock, &message, size, 0 ) >= 0 ) {
+			return TsStatusOk;
+		}
+	} while( errno == EINTR );
+	return _ts_datagram_status( "ts_driver_write", TsStatusOkWritePending );
+}
 
-		// read from the socket
-		ssize_t size = recv( sock->_fd, (void *) ( buffer + index ), ( *buffer_size ) - index, flags );
-		if( size < 0 ) {
-
-			// recv has indicated either non-block status
-			// or an actual driver issue,...
-			size = 0;
-			reading = false;
+/**
+ * Return the next datagram, receiving a batch when none is queued. Read wait and budget
+ * semantics are those of ts_read.
+ */
+static TsStatus_t _ts_datagram_read( TsDriverSocketRef_t sock, uint8_t * buffer, size_t * buffer_size, uint64_t timestamp, uint32_t budget ) {
 
-			// establish the exit scenario for the caller
-			if( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) {
-				if( index > 0 ) {
-					status = TsStatusOk;
-				} else {
-					// TODO - allow the timer budget to be exhausted before returning?
-					status = TsStatusOkReadPending;
-				}
-			} else if( errno == EPIPE || errno == ECONNRESET ) {
+	TsStatus_t status = TsStatusOkReadPending;
+	while( sock->_datagram_in_count == 0 ) {
+		if( _ts_datagram_receive( sock ) < 0 ) {
+			if( errno == EINTR ) {
+				continue;
+			}
+			if(( errno == EWOULDBLOCK || errno == EAGAIN ) && sock->_read_wait && _ts_read_wait( sock, timestamp, budget )) {
+				continue;
+			}
+			status = _ts_datagram_status( "ts_driver_read", TsStatusOkReadPending );
+			break;
+		}
+		if( ts_platform_time() - timestamp > budget ) {
+			// only empty datagrams so far
+			break;
+		}
+	}
+
+	size_t size = 0;
+	if( sock->_datagram_in_count > 0 ) {
+		const uint8_t * data;
+		size = _ts_datagram_next( sock, &data );
+		if( size > *buffer_size ) {
+			ts_status_debug( "ts_driver_read: datagram truncated to the buffer\n" );
+			size = *buffer_size;
+		}
+		memcpy( buffer, data, size );
+		status = TsStatusOk;
+	}
+	*buffer_size = size;
+	return status;
+}
+
+/**
+ * Hand the given data to the reader. The reader may disconnect the driver (and connect it
+ * again) or unregister itself, false tells the caller to stop using the connection and the
+ * reader buffer.
+ */
+static bool _ts_reader_deliver( TsDriverSocketRef_t sock, const uint8_t * data, size_t size ) {
+
+	uint32_t connection = sock->_connection;
+	sock->_driver._reader( (TsDriverRef_t) sock, sock->_driver._reader_state, data, size );
+	return sock->_connection == connection && sock->_fd >= 0 && sock->_driver._reader != NULL;
+}
+
+/**
+ * Hand the received datagrams to the reader, one call per datagram, until the socket
+ * is empty or the budget is used up.
+ */
+static TsStatus_t _ts_datagram_tick( TsDriverSocketRef_t sock, uint64_t timestamp, uint32_t budget ) {
+
+	TsStatus_t status = TsStatusOk;
+	while( true ) {
+
+		while( sock->_datagram_in_count > 0 ) {
+			const uint8_t * data;
+			size_t size = _ts_datagram_next( sock, &data );
+			_ts_stats_count( sock, _bytes_in, size );
+			if( !_ts_reader_deliver( sock, data, size )) {
+				return TsStatusOk;
+			}
+		}
+		if( ts_platform_time() - timestamp > budget ) {
+			ts_status_debug( "ts_driver_tick: timer budget exceeded\n" );
+			_ts_stats_count( sock, _budget_overruns, 1 );
+			break;
+		}
+		if( _ts_datagram_receive( sock ) < 0 && errno != EINTR ) {
+			status = _ts_datagram_status( "ts_driver_tick", TsStatusOk );
+			break;
+		}
+	}
+	return status;
+}
+
+// reconnect
+//
+// with _reconnect_initial in the profile, a lost connection is re-established from
+// ts_tick. attempts are spaced with "full jitter" exponential backoff, i.e., a uniformly
+// random delay up to a ceiling that doubles per failed attempt, so that devices which
+// lost their connections together, e.g., in a regional outage, spread their attempts
+// instead of reconnecting in lockstep. the generator is seeded per device (see
+// ts_platform_random). writes made between connections are held in a bounded queue.
+
+static void _ts_reconnect_tick( TsDriverSocketRef_t );
+
+// between connections, reads are pending and writes are held
+static bool _ts_reconnecting( TsDriverSocketRef_t sock ) {
+	return sock->_state == TsDriverUnixStateBackoff || sock->_state == TsDriverUnixStateConnecting;
+}
+
+static void _ts_reconnect_enter( TsDriverSocketRef_t sock, TsDriverUnixState_t state ) {
+
+	if( sock->_state == state ) {
+		return;
+	}
+	sock->_state = state;
+	if( sock->_reconnect_callback != NULL ) {
+		sock->_reconnect_callback( (TsDriverRef_t) sock, sock->_reconnect_state, state );
+	}
+}
+
+/**
+ * Pick the start of the next attempt, a random delay of up to the current ceiling.
+ */
+static void _ts_reconnect_schedule( TsDriverSocketRef_t sock ) {
+
+	uint64_t maximum = sock->_unix_profile._reconnect_max;
+	if( maximum == 0 ) {
+		maximum = TS_DRIVER_UNIX_RECONNECT_MAX;
+	}
+	uint64_t ceiling = sock->_unix_profile._reconnect_initial;
+	for( uint32_t i = 0; i < sock->_attempts && ceiling < maximum; i++ ) {
+		ceiling = ceiling * 2;
+	}
+	if( ceiling > maximum ) {
+		ceiling = maximum;
+	}
+
+	uint32_t random;
+	ts_platform_random( &random );
+	sock->_attempt_at = ts_platform_time() + random % ( ceiling + 1 );
+	sock->_attempts = sock->_attempts + 1;
+	ts_status_debug( "ts_driver_reconnect: attempt %u in %u usec\n", sock->_attempts, (uint32_t) ( sock->_attempt_at - ts_platform_time() ));
+	_ts_reconnect_enter( sock, TsDriverUnixStateBackoff );
+}
+
+/**
+ * Close the socket and drop what belongs to the connection.
+ */
+static void _ts_close( TsDriverSocketRef_t sock ) {
+
+	if( sock->_fd >= 0 ) {
+		close( sock->_fd );
+	}
+	sock->_fd = -1;
+	sock->_connection = sock->_connection + 1;
+	sock->_ring_head = 0;
+	sock->_ring_tail = 0;
+
+	// the connection is gone, nothing more will be sent from outstanding buffers
+	if( sock->_zerocopy_done != sock->_zerocopy_next ) {
+		_ts_zerocopy_complete( sock, sock->_zerocopy_done, sock->_zerocopy_next - 1 );
+	}
+	sock->_zerocopy_next = 0;
+	sock->_zerocopy_done = 0;
+
+	// queued datagrams are dropped with the connection
+	sock->_datagram_out_count = 0;
+	sock->_datagram_in_head = 0;
+	sock->_datagram_in_count = 0;
+
+	// as are the passed descriptors no one took
+	for( int i = 0; i < sock->_fds_count; i++ ) {
+		close( sock->_fds[ i ] );
+	}
+	sock->_fds_count = 0;
+}
+
+/**
+ * Start reconnecting when the given status of a call reports the connection lost.
+ */
+static TsStatus_t _ts_reconnect_check( TsDriverSocketRef_t sock, TsStatus_t status ) {
+
+	if( status == TsStatusErrorConnectionReset && sock->_reconnect && sock->_state == TsDriverUnixStateConnected ) {
+		ts_status_info( "ts_driver_reconnect: connection lost\n" );
+
+		// the callback is told while the descriptor is still open, e.g., to stop waiting on
+		// it, unless it connected or disconnected meanwhile, the next attempt is scheduled
+		_ts_reconnect_enter( sock, TsDriverUnixStateBackoff );
+		if( sock->_state == TsDriverUnixStateBackoff ) {
+			_ts_close( sock );
+			sock->_attempts = 0;
+			_ts_reconnect_schedule( sock );
+		}
+	}
+	return status;
+}
+
+/**
+ * Send the held writes, as far as the socket takes them.
+ */
+static TsStatus_t _ts_queue_flush( TsDriverSocketRef_t sock ) {
+
+	size_t sent = 0;
+	TsStatus_t status = TsStatusOk;
+	while( sent < sock->_queue_used ) {
+		ssize_t size = send( sock->_fd, sock->_queue + sent, sock->_queue_used - sent, MSG_NOSIGNAL );
+		_ts_stats_count( sock, _write_syscalls, 1 );
+		if( size > 0 ) {
+			sent = sent + (size_t) size;
+		} else if( size < 0 && errno == EINTR ) {
+			continue;
+		} else {
+			if( size < 0 && ( errno == EPIPE || errno == ECONNRESET )) {
 				status = TsStatusErrorConnectionReset;
-			} else if( errno != 0 ) {
-				ts_status_debug( "ts_driver_read: ignoring error, %d\n", errno );
+			} else if( size < 0 && errno != EWOULDBLOCK && errno != EAGAIN ) {
+				ts_status_debug( "ts_driver_reconnect: ignoring error, %d\n", errno );
 				status = TsStatusErrorInternalServerError;
 			}
+			break;
+		}
+	}
+	_ts_stats_count( sock, _bytes_out, sent );
 
-		} else if( size == 0 ) {
+	sock->_queue_used = sock->_queue_used - sent;
+	if( sock->_queue_used > 0 && sent > 0 ) {
+		memmove( sock->_queue, sock->_queue + sent, sock->_queue_used );
+	}
+	return status;
+}
 
-			// first normal exit condition, non-block io read returns zero bytes
-			reading = false;
-			status = TsStatusOk;
+/**
+ * Whether a write must be held: between connections, or while earlier held writes are
+ * still unsent (those are sent first, as far as the socket takes them).
+ */
+static bool _ts_queue_hold( TsDriverSocketRef_t sock ) {
 
-		} else if( ts_platform_time() - timestamp > budget ) {
+	if( _ts_reconnecting( sock )) {
+		return true;
+	}
+	if( sock->_queue_used == 0 || sock->_queue_paused ) {
+		return false;
+	}
+	_ts_reconnect_check( sock, _ts_queue_flush( sock ));
+	return sock->_queue_used > 0 || _ts_reconnecting( sock );
+}
 
-			// there is more to read than expected on this attempt,
-			// give back control to caller
-			ts_status_debug( "ts_driver_read: timer budget exceeded\n" );
-			reading = false;
+/**
+ * Hold (a copy of) as much of the given vector as fits, returns the number of bytes taken
+ * in size. Datagrams are not held.
+ */
+static TsStatus_t _ts_queue_append( TsDriverSocketRef_t sock, const struct iovec * vector, int count, size_t * size ) {
 
-			if( index > 0 ) {
-				status = TsStatusOk;
-			} else {
-				status = TsStatusOkReadPending;
-			}
+	if( sock->_queue == NULL && sock->_unix_profile._reconnect_queue > 0 ) {
+		sock->_queue = (uint8_t *) ts_platform_malloc( sock->_unix_profile._reconnect_queue );
+		if( sock->_queue == NULL ) {
+			*size = 0;
+			return TsStatusErrorInternalServerError;
 		}
+		sock->_queue_size = sock->_unix_profile._reconnect_queue;
+	}
 
-		index = index + size;
+	size_t taken = 0;
+	for( int i = 0; i < count && !sock->_datagram && sock->_queue_used < sock->_queue_size; i++ ) {
+		size_t part = vector[ i ].iov_len;
+		if( part > sock->_queue_size - sock->_queue_used ) {
+			part = sock->_queue_size - sock->_queue_used;
+		}
+		memcpy( sock->_queue + sock->_queue_used, vector[ i ].iov_base, part );
+		sock->_queue_used = sock->_queue_used + part;
+		taken = taken + part;
+	}
+	*size = taken;
+	return ( taken > 0 ) ? TsStatusOk : TsStatusOkWritePending;
+}
 
-		if( index >= *buffer_size ) {
-			// second normal exit condition, the buffer is full
-			reading = false;
-			status = TsStatusOk;
+/**
+ * Account for the outcome of a connect (or reconnect attempt). Once connected the callback
+ * is told first, so that what it writes goes ahead of the held writes, then those are sent.
+ * A failure with reconnecting enabled schedules the next attempt.
+ */
+static TsStatus_t _ts_connect_result( TsDriverSocketRef_t sock, TsStatus_t status ) {
+
+	if( status == TsStatusOk ) {
+
+		_ts_stats_count( sock, _reconnects, sock->_stats._connects > 0 ? 1 : 0 );
+		_ts_stats_count( sock, _connects, 1 );
+		sock->_attempts = 0;
+
+		sock->_queue_paused = true;
+		_ts_reconnect_enter( sock, TsDriverUnixStateConnected );
+		sock->_queue_paused = false;
+		if( sock->_state == TsDriverUnixStateConnected && sock->_queue_used > 0 ) {
+			_ts_reconnect_check( sock, _ts_queue_flush( sock ));
 		}
 
-	} while( reading );
+	} else if( sock->_reconnect ) {
 
-	// update read buffer size and return
-	*buffer_size = (size_t) index;
+		_ts_reconnect_schedule( sock );
+	}
 	return status;
 }
 
-static TsStatus_t ts_reader( TsDriverRef_t driver, void * data, TsDriverReader_t reader ) {
-	return TsStatusErrorNotImplemented;
+static TsStatus_t ts_create( TsDriverRef_t * driver ) {
+
+	ts_status_trace( "ts_driver_create: socket\n" );
+	ts_platform_assert( driver != NULL );
+
+	// TODO - init sockets?
+	//sigignore(SIGHUP);
+	//sigignore(SIGINT);
+	//sigignore(SIGPIPE);
+	//sigignore(SIGALRM);
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( ts_platform_malloc( sizeof( TsDriverSocket_t )));
+	sock->_driver._address = "";
+	sock->_driver._profile = NULL;
+	sock->_driver._reader = NULL;
+	sock->_driver._reader_state = NULL;
+	sock->_driver._spec_budget = 60*TS_TIME_SEC_TO_USEC;
+	sock->_driver._spec_mtu = 2048;
+	// TODO - should provide mac address here? probably not
+	// TODO - currently using my own mac-id - need to change this asap.
+	snprintf((char *) ( sock->_driver._spec_id ), TS_DRIVER_MAX_ID_SIZE, "%s", "B827EBA15910" );
+	sock->_fd = -1;
+	sock->_last_read_timestamp = 0;
+	sock->_reader_buffer = NULL;
+	sock->_read_wait = false;
+	sock->_connection = 0;
+	memset( &( sock->_unix_profile ), 0x00, sizeof( TsDriverUnixProfile_t ));
+	sock->_ring = NULL;
+	sock->_ring_size = 0;
+	sock->_ring_head = 0;
+	sock->_ring_tail = 0;
+	sock->_ring_mirrored = false;
+	sock->_zerocopy = false;
+	sock->_zerocopy_next = 0;
+	sock->_zerocopy_done = 0;
+	sock->_zerocopy_callback = NULL;
+	sock->_zerocopy_state = NULL;
+	sock->_datagram = false;
+	sock->_datagram_out = NULL;
+	sock->_datagram_out_count = 0;
+	sock->_datagram_in = NULL;
+	sock->_datagram_in_head = 0;
+	sock->_datagram_in_count = 0;
+	sock->_local = false;
+	sock->_fds_count = 0;
+	sock->_state = TsDriverUnixStateIdle;
+	sock->_reconnect = false;
+	sock->_address[ 0 ] = '\0';
+	sock->_addresses = NULL;
+	sock->_attempts = 0;
+	sock->_attempt_at = 0;
+	sock->_reconnect_callback = NULL;
+	sock->_reconnect_state = NULL;
+	sock->_queue = NULL;
+	sock->_queue_size = 0;
+	sock->_queue_used = 0;
+	sock->_queue_paused = false;
+#if defined(TS_DRIVER_STATS)
+	memset( &( sock->_stats ), 0x00, sizeof( TsDriverUnixStats_t ));
+#endif
+
+	*driver = (TsDriverRef_t) sock;
+
+	return TsStatusOk;
 }
 
-static TsStatus_t ts_write( TsDriverRef_t driver, const uint8_t * buffer, size_t * buffer_size, uint32_t budget ) {
+static TsStatus_t ts_destroy( TsDriverRef_t driver ) {
 
-	ts_status_trace( "ts_driver_write\n" );
+	ts_status_trace( "ts_driver_destroy\n" );
 	ts_platform_assert( driver != NULL );
-	ts_platform_assert( buffer != NULL );
-	ts_platform_assert( buffer_size != NULL );
-	ts_platform_assert( *buffer_size > 0 );
 
 	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( sock->_reader_buffer != NULL ) {
+		ts_platform_free( sock->_reader_buffer, sock->_driver._spec_mtu );
+	}
+	if( sock->_ring != NULL && sock->_ring_mirrored ) {
+		munmap( sock->_ring, 2 * sock->_ring_size );
+	} else if( sock->_ring != NULL ) {
+		ts_platform_free( sock->_ring, sock->_ring_size );
+	}
+	if( sock->_datagram_out != NULL ) {
+		ts_platform_free( sock->_datagram_out, TS_DRIVER_UNIX_DATAGRAM_BATCH * sock->_driver._spec_mtu );
+	}
+	if( sock->_datagram_in != NULL ) {
+		ts_platform_free( sock->_datagram_in, TS_DRIVER_UNIX_DATAGRAM_BATCH * sock->_driver._spec_mtu );
+	}
+	if( sock->_queue != NULL ) {
+		ts_platform_free( sock->_queue, sock->_queue_size );
+	}
+	ts_resolver_release( sock->_addresses );
+	ts_platform->free( sock, sizeof( TsDriverSocket_t ));
 
-	// initialize timestamp for write timer budgeting
+	return TsStatusOk;
+}
+
+/**
+ * Provide the socket driver processing time. When a reader is registered, drain the socket
+ * while it is readable and deliver the data to the reader, a buffer (up to the mtu) at a time,
+ * so that an inbound burst is consumed in a single pass without polling read from above.
+ * Datagrams are delivered one per call. With reconnecting enabled, a lost connection is
+ * re-established here, see ts_driver_unix_reconnect.
+ *
+ * @return
+ * TsStatusOk                   - Nothing (more) to read, or the budget was used up
+ * TsStatusErrorConnectionReset - The peer closed or reset the connection
+ * TsStatusError*               - Indicates an error has occurred, see ts_status.h for more information.
+ */
+static TsStatus_t ts_tick( TsDriverRef_t driver, uint32_t budget ) {
+
+	ts_status_trace( "ts_driver_tick\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( sock->_reconnect ) {
+		_ts_reconnect_tick( sock );
+	}
+	if( sock->_fd >= 0 && sock->_zerocopy ) {
+		_ts_zerocopy_reap( sock );
+	}
+	if( sock->_driver._reader == NULL || sock->_fd < 0 || _ts_reconnecting( sock )) {
+		return TsStatusOk;
+	}
+
+	// initialize timestamp for read timer budgeting
 	uint64_t timestamp = ts_platform_time();
 
-	// perform write
-	int flags = 0x00;
-	bool writing = true;
-	ssize_t index = 0;
+	bool reading = true;
+	size_t index = 0;
 	TsStatus_t status = TsStatusOk;
-	do {
+	if( sock->_datagram ) {
+		status = _ts_datagram_tick( sock, timestamp, budget );
+		reading = false;
+	}
+	while( reading ) {
 
-		// write to the socket
-		ssize_t size = send( sock->_fd, buffer + index, *buffer_size - index, flags );
-		if( size < 0 ) {
+		ssize_t size = _ts_recv( sock, sock->_reader_buffer + index, sock->_driver._spec_mtu - index, 0 );
+		_ts_stats_count( sock, _read_syscalls, 1 );
+		if( size > 0 ) {
 
-			// send has indicated either non-block status
-			// or an actual driver issue,...
-			size = 0;
-			writing = false;
+			index = index + (size_t) size;
+			_ts_stats_count( sock, _bytes_in, (size_t) size );
 
-			// establish exit scenarip for the caller
-			if( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) {
-				if( index > 0 ) {
-					status = TsStatusOk;
-				} else {
-					status = TsStatusOkWritePending;
-				}
+		} else if( size == 0 ) {
+
+			// orderly shutdown by the peer
+			reading = false;
+			status = TsStatusErrorConnectionReset;
+
+		} else if( errno == EINTR ) {
+
+			continue;
+
+		} else {
+
+			reading = false;
+			if( errno == EWOULDBLOCK || errno == EAGAIN ) {
+				status = TsStatusOk;
 			} else if( errno == EPIPE || errno == ECONNRESET ) {
 				status = TsStatusErrorConnectionReset;
-			} else if( errno != 0 ) {
-				ts_status_debug( "ts_driver_write: ignoring error, %d\n", errno );
+			} else {
+				ts_status_debug( "ts_driver_tick: ignoring error, %d\n", errno );
 				status = TsStatusErrorInternalServerError;
 			}
+		}
 
-		} else if( size == 0 ) {
+		// deliver a full buffer right away, and whatever is left on exit
+		if( index > 0 && ( index == sock->_driver._spec_mtu || !reading )) {
+			size_t size = index;
+			index = 0;
+			if( !_ts_reader_deliver( sock, sock->_reader_buffer, size )) {
+				break;
+			}
+		}
 
-			// unexpected non-blocking call returns zero bytes
-			ts_status_info( "ts_driver_write: unexpected empty write occured\n" );
-			writing = false;
+		if( reading && ts_platform_time() - timestamp > budget ) {
+			// there is more to read than expected on this attempt,
+			// give back control to caller
+			ts_status_debug( "ts_driver_tick: timer budget exceeded\n" );
+			_ts_stats_count( sock, _budget_overruns, 1 );
+			reading = false;
 			if( index > 0 ) {
-				status = TsStatusOk;
-			} else {
-				status = TsStatusOkWritePending;
+				_ts_reader_deliver( sock, sock->_reader_buffer, index );
 			}
+		}
+	}
 
-		} else if( ts_platform_time() - timestamp > budget ) {
+	if( status != TsStatusOk ) {
+		ts_status_alarm( "ts_driver_tick: reader failed, %s\n", ts_status_string( status ));
+	}
+	return _ts_reconnect_check( sock, status );
+}
 
-			// there is more to write, but dont give control back to the caller
-			ts_status_debug( "ts_driver_write: ignoring timer budget exceeded\n" );
-		}
+static void _ts_set_option( int fd, int level, int name, int value, const char * label ) {
 
-		index = index + size;
+	if( setsockopt( fd, level, name, &value, sizeof( value )) < 0 ) {
+		ts_status_debug( "ts_driver_profile: ignoring %s error, %d\n", label, errno );
+	}
+}
 
-		if( index >= *buffer_size ) {
+static int _ts_get_option( int fd, int level, int name ) {
 
+	int value = 0;
+	socklen_t length = sizeof( value );
+	if( getsockopt( fd, level, name, &value, &length ) < 0 ) {
+		return 0;
+	}
+	return value;
+}
+
+/**
+ * Apply the unix profile to the given (new or connected) socket, zero valued options are
+ * left at the system default. Failures are logged and otherwise ignored, the socket is
+ * usable with the system defaults.
+ */
+static void _ts_apply_profile( TsDriverSocketRef_t sock, int fd ) {
+
+	TsDriverUnixProfile_t * profile = &( sock->_unix_profile );
+
+	// ip (and tcp) options do not apply to local sockets
+	struct sockaddr_storage local;
+	socklen_t length = sizeof( local );
+	int family = ( getsockname( fd, (struct sockaddr *) &local, &length ) == 0 ) ? local.ss_family : AF_UNSPEC;
+	bool ip = family != AF_UNIX;
+	bool tcp = ip && _ts_get_option( fd, SOL_SOCKET, SO_TYPE ) == SOCK_STREAM;
+
+#if defined(SO_NOSIGPIPE)
+	// no MSG_NOSIGNAL on these systems
+	_ts_set_option( fd, SOL_SOCKET, SO_NOSIGPIPE, 1, "SO_NOSIGPIPE" );
+#endif
+
+	if( tcp ) {
+		_ts_set_option( fd, IPPROTO_TCP, TCP_NODELAY, profile->_nodelay ? 1 : 0, "TCP_NODELAY" );
+#if defined(TCP_CORK)
+		_ts_set_option( fd, IPPROTO_TCP, TCP_CORK, profile->_cork ? 1 : 0, "TCP_CORK" );
+#elif defined(TCP_NOPUSH)
+		_ts_set_option( fd, IPPROTO_TCP, TCP_NOPUSH, profile->_cork ? 1 : 0, "TCP_NOPUSH" );
+#endif
+	}
+
+	// buffer sizes must be set before connect to affect the window scale
+	if( profile->_rcvbuf > 0 ) {
+		_ts_set_option( fd, SOL_SOCKET, SO_RCVBUF, profile->_rcvbuf, "SO_RCVBUF" );
+	}
+	if( profile->_sndbuf > 0 ) {
+		_ts_set_option( fd, SOL_SOCKET, SO_SNDBUF, profile->_sndbuf, "SO_SNDBUF" );
+	}
+
+	// detect a dead peer on the transport rather than waiting for protocol pings
+	if( tcp && profile->_keepalive_idle > 0 ) {
+		_ts_set_option( fd, SOL_SOCKET, SO_KEEPALIVE, 1, "SO_KEEPALIVE" );
+#if defined(TCP_KEEPIDLE)
+		_ts_set_option( fd, IPPROTO_TCP, TCP_KEEPIDLE, profile->_keepalive_idle, "TCP_KEEPIDLE" );
+#elif defined(TCP_KEEPALIVE)
+		_ts_set_option( fd, IPPROTO_TCP, TCP_KEEPALIVE, profile->_keepalive_idle, "TCP_KEEPALIVE" );
+#endif
+#if defined(TCP_KEEPINTVL)
+		if( profile->_keepalive_interval > 0 ) {
+			_ts_set_option( fd, IPPROTO_TCP, TCP_KEEPINTVL, profile->_keepalive_interval, "TCP_KEEPINTVL" );
+		}
+#endif
+#if defined(TCP_KEEPCNT)
+		if( profile->_keepalive_count > 0 ) {
+			_ts_set_option( fd, IPPROTO_TCP, TCP_KEEPCNT, profile->_keepalive_count, "TCP_KEEPCNT" );
+		}
+#endif
+	}
+#if defined(TCP_USER_TIMEOUT)
+	if( tcp && profile->_user_timeout > 0 ) {
+		_ts_set_option( fd, IPPROTO_TCP, TCP_USER_TIMEOUT, profile->_user_timeout, "TCP_USER_TIMEOUT" );
+	}
+#endif
+#if defined(SO_BUSY_POLL)
+	if( profile->_busy_poll > 0 ) {
+		_ts_set_option( fd, SOL_SOCKET, SO_BUSY_POLL, profile->_busy_poll, "SO_BUSY_POLL" );
+	}
+#endif
+
+#if defined(TS_DRIVER_ZEROCOPY)
+	if( ip && profile->_zerocopy_threshold > 0 ) {
+		int value = 1;
+		sock->_zerocopy = setsockopt( fd, SOL_SOCKET, SO_ZEROCOPY, &value, sizeof( value )) == 0;
+		if( !sock->_zerocopy ) {
+			ts_status_debug( "ts_driver_profile: zero-copy not available, %d\n", errno );
+		}
+	} else {
+		sock->_zerocopy = false;
+	}
+#endif
+
+	if( ip && profile->_tos > 0 ) {
+		if( family == AF_INET6 ) {
+			_ts_set_option( fd, IPPROTO_IPV6, IPV6_TCLASS, profile->_tos, "IPV6_TCLASS" );
+		} else {
+			_ts_set_option( fd, IPPROTO_IP, IP_TOS, profile->_tos, "IP_TOS" );
+		}
+	}
+}
+
+#if !defined(TS_UNIX_SIMPLE_SOCKET)
+/**
+ * Connect to the first address that answers, happy eyeballs style (rfc 8305). Non-blocking
+ * attempts are started a stagger apart, alternating address families, and raced; the next
+ * attempt starts early when one fails. The whole race is bounded by the driver budget.
+ */
+static TsStatus_t _ts_connect_async( TsDriverSocketRef_t sock, struct addrinfo * address_list ) {
+
+	// order the candidates, alternating families starting with the resolver's first choice
+	struct addrinfo * candidates[ TS_DRIVER_UNIX_CONNECT_MAX ];
+	int count = 0;
+	int family = address_list->ai_family;
+	struct addrinfo * preferred = address_list;
+	struct addrinfo * other = address_list;
+	while( count < TS_DRIVER_UNIX_CONNECT_MAX ) {
+		while( preferred != NULL && preferred->ai_family != family ) {
+			preferred = preferred->ai_next;
+		}
+		while( other != NULL && other->ai_family == family ) {
+			other = other->ai_next;
+		}
+		if( preferred == NULL && other == NULL ) {
+			break;
+		}
+		if( preferred != NULL ) {
+			candidates[ count++ ] = preferred;
+			preferred = preferred->ai_next;
+		}
+		if( other != NULL && count < TS_DRIVER_UNIX_CONNECT_MAX ) {
+			candidates[ count++ ] = other;
+			other = other->ai_next;
+		}
+	}
+
+	uint32_t stagger = sock->_unix_profile._connect_stagger;
+	if( stagger == 0 ) {
+		stagger = TS_DRIVER_UNIX_CONNECT_STAGGER;
+	}
+
+	uint64_t timestamp = ts_platform_time();
+	uint64_t next_start = timestamp;
+	struct pollfd pending[ TS_DRIVER_UNIX_CONNECT_MAX ];
+	int pending_count = 0;
+	int next = 0;
+	int winner = -1;
+
+	while( winner < 0 ) {
+
+		uint64_t now = ts_platform_time();
+		if( now - timestamp >= sock->_driver._spec_budget ) {
+			ts_status_debug( "ts_driver_connect: connect budget exceeded\n" );
+			break;
+		}
+
+		// start the next attempt when its turn has come, or nothing is in flight
+		if( next < count && ( now >= next_start || pending_count == 0 )) {
+
+			struct addrinfo * current = candidates[ next++ ];
+			next_start = now + stagger;
+
+			int fd = (int) socket( current->ai_family, current->ai_socktype, current->ai_protocol );
+			if( fd < 0 ) {
+				continue;
+			}
+			if( fcntl( fd, F_SETFL, fcntl( fd, F_GETFL, 0 ) | O_NONBLOCK ) == -1 ) {
+				close( fd );
+				continue;
+			}
+			_ts_apply_profile( sock, fd );
+			if( connect( fd, current->ai_addr, current->ai_addrlen ) == 0 ) {
+				winner = fd;
+				break;
+			}
+			if( errno != EINPROGRESS ) {
+				ts_status_debug( "ts_driver_connect: attempt failed, %d\n", errno );
+				close( fd );
+				next_start = now;
+				continue;
+			}
+			pending[ pending_count ].fd = fd;
+			pending[ pending_count ].events = POLLOUT;
+			pending[ pending_count ].revents = 0;
+			pending_count = pending_count + 1;
+		}
+		if( pending_count == 0 ) {
+			if( next >= count ) {
+				break;
+			}
+			continue;
+		}
+
+		// wait for an attempt to complete, the next start or the end of the budget
+		uint64_t until = timestamp + sock->_driver._spec_budget;
+		if( next < count && next_start < until ) {
+			until = next_start;
+		}
+		now = ts_platform_time();
+		int timeout = until > now ? (int) (( until - now + 999 ) / 1000 ) : 0;
+		if( poll( pending, (nfds_t) pending_count, timeout ) < 0 && errno != EINTR ) {
+			ts_status_debug( "ts_driver_connect: poll error, %d\n", errno );
+			break;
+		}
+
+		for( int i = 0; i < pending_count && winner < 0; i++ ) {
+			if( pending[ i ].revents == 0 ) {
+				continue;
+			}
+			int error = 0;
+			socklen_t length = sizeof( error );
+			if( getsockopt( pending[ i ].fd, SOL_SOCKET, SO_ERROR, &error, &length ) == 0 && error == 0 ) {
+				winner = pending[ i ].fd;
+			} else {
+				ts_status_debug( "ts_driver_connect: attempt failed, %d\n", error );
+				close( pending[ i ].fd );
+				next_start = ts_platform_time();
+			}
+			pending_count = pending_count - 1;
+			pending[ i ] = pending[ pending_count ];
+			i = i - 1;
+		}
+	}
+
+	// abandon the attempts that lost the race
+	for( int i = 0; i < pending_count; i++ ) {
+		close( pending[ i ].fd );
+	}
+	if( winner < 0 ) {
+		return TsStatusErrorBadGateway;
+	}
+	sock->_fd = winner;
+	return TsStatusOk;
+}
+#endif
+
+static void _ts_address_hints( TsDriverSocketRef_t sock, struct addrinfo * hints ) {
+
+	memset( hints, 0x00, sizeof( struct addrinfo ));
+	hints->ai_family = AF_UNSPEC;
+	hints->ai_socktype = sock->_datagram ? SOCK_DGRAM : SOCK_STREAM;
+	hints->ai_protocol = sock->_datagram ? IPPROTO_UDP : IPPROTO_TCP;
+}
+
+/**
+ * Connect to the local (unix domain) socket at the given path, bypassing the resolver and
+ * the tcp stack. A leading '@' names a socket in the linux abstract namespace.
+ */
+static TsStatus_t _ts_connect_local( TsDriverSocketRef_t sock, const char * path ) {
+
+	struct sockaddr_un server;
+	memset( &server, 0x00, sizeof( server ));
+	server.sun_family = AF_UNIX;
+	size_t length = strlen( path );
+	if( length == 0 || length >= sizeof( server.sun_path )) {
+		return TsStatusErrorBadRequest;
+	}
+	memcpy( server.sun_path, path, length );
+	socklen_t size = (socklen_t) ( offsetof( struct sockaddr_un, sun_path ) + length + 1 );
+#if defined(__linux__)
+	if( path[ 0 ] == '@' ) {
+		// abstract names are not terminated
+		server.sun_path[ 0 ] = '\0';
+		size = size - 1;
+	}
+#endif
+
+	sock->_fd = (int) socket( AF_UNIX, sock->_datagram ? SOCK_DGRAM : SOCK_STREAM, 0 );
+	if( sock->_fd < 0 ) {
+		return TsStatusErrorInternalServerError;
+	}
+	_ts_apply_profile( sock, sock->_fd );
+	if( connect( sock->_fd, (struct sockaddr *) &server, size ) != 0 ) {
+		int error = errno;
+		ts_status_debug( "ts_driver_connect: cannot connect to %s, %d\n", path, error );
+		close( sock->_fd );
+		sock->_fd = -1;
+		return ( error == ENOENT ) ? TsStatusErrorNotFound : TsStatusErrorBadGateway;
+	}
+	if( fcntl( sock->_fd, F_SETFL, fcntl( sock->_fd, F_GETFL, 0 ) | O_NONBLOCK ) == -1 ) {
+		close( sock->_fd );
+		sock->_fd = -1;
+		return TsStatusErrorInternalServerError;
+	}
+	sock->_local = true;
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_connect( TsDriverRef_t driver, TsAddress_t address ) {
+
+	ts_status_trace( "ts_driver_connect\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsStatus_t status = TsStatusErrorNotFound;
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( _ts_reconnecting( sock )) {
+		// the explicit connect takes over from the reconnect attempts
+		_ts_close( sock );
+	}
+	sock->_datagram = sock->_unix_profile._datagram;
+	sock->_local = false;
+
+	// keep the address for reconnecting
+	sock->_reconnect = sock->_unix_profile._reconnect_initial > 0;
+	if( snprintf( sock->_address, sizeof( sock->_address ), "%s", address ) >= (int) sizeof( sock->_address )) {
+		ts_status_debug( "ts_driver_connect: address too long to reconnect\n" );
+		sock->_reconnect = false;
+	}
+	ts_resolver_release( sock->_addresses );
+	sock->_addresses = NULL;
+
+	if( strncmp( address, TS_DRIVER_UNIX_LOCAL, sizeof( TS_DRIVER_UNIX_LOCAL ) - 1 ) == 0 ) {
+		status = _ts_connect_local( sock, address + sizeof( TS_DRIVER_UNIX_LOCAL ) - 1 );
+		return _ts_connect_result( sock, status );
+	}
+
+	// TODO - should really pattern match to see if this is an IP or an FQDN
+#if defined(TS_UNIX_SIMPLE_SOCKET)
+	struct sockaddr_in server;
+	sock->_reconnect = false; // the attempts need the resolved addresses
+	_ts_reconnect_enter( sock, TsDriverUnixStateIdle );
+	sock->_fd = socket(AF_INET, sock->_datagram ? SOCK_DGRAM : SOCK_STREAM , 0);
+	if( sock->_fd == -1 ) {
+		return TsStatusErrorInternalServerError;
+	}
+	_ts_apply_profile( sock, sock->_fd );
+
+	char host[256], port[8];
+	ts_address_parse( address, host, port );
+
+	server.sin_addr.s_addr = inet_addr( host );
+	server.sin_family = AF_INET;
+	server.sin_port = htons( atoi( port ) );
+
+	if (connect( sock->_fd , (struct sockaddr *)&server , sizeof(server)) == 0) {
+
+		if( fcntl( sock->_fd, F_SETFL, fcntl( sock->_fd, F_GETFL, 0 ) | O_NONBLOCK ) == -1 ) {
+
+			status = TsStatusErrorInternalServerError;
+
+		} else {
+
+			status = TsStatusOk;
+		}
+	}
+#else
+	// init address hints
+	struct addrinfo hints;
+	_ts_address_hints( sock, &hints );
+
+	// decode and resolve address
+	char host[TS_ADDRESS_MAX_HOST_SIZE];
+	char port[TS_ADDRESS_MAX_PORT_SIZE];
+	if( ts_address_parse( address, host, port ) != TsStatusOk ) {
+		sock->_reconnect = false;
+		_ts_reconnect_enter( sock, TsDriverUnixStateIdle );
+		return TsStatusErrorInternalServerError;
+	}
+	struct addrinfo * address_list;
+	if( ts_resolver_resolve( host, port, &hints, &address_list ) != TsStatusOk ) {
+		// nothing to reconnect to, the attempts do not resolve (which may block)
+		sock->_reconnect = false;
+		_ts_reconnect_enter( sock, TsDriverUnixStateIdle );
+		return TsStatusErrorNotFound;
+	}
+
+	// find active listener
+	struct addrinfo * current = address_list;
+	if( sock->_unix_profile._connect_async ) {
+		status = _ts_connect_async( sock, address_list );
+		current = NULL;
+	}
+	for( ; current != NULL; current = current->ai_next ) {
+
+		sock->_fd = (int) socket( current->ai_family, current->ai_socktype, current->ai_protocol );
+		if( sock->_fd < 0 ) {
+			status = TsStatusErrorNotFound;
+			continue;
+		}
+		_ts_apply_profile( sock, sock->_fd );
+		if( connect( sock->_fd, current->ai_addr, current->ai_addrlen ) == 0 ) {
+
+			if( fcntl( sock->_fd, F_SETFL, fcntl( sock->_fd, F_GETFL, 0 ) | O_NONBLOCK ) == -1 ) {
+				status = TsStatusErrorInternalServerError;
+				close( sock->_fd );
+				continue;
+			}
+			status = TsStatusOk;
+			break;
+		}
+		status = TsStatusErrorBadGateway;
+		_ts_close( sock );
+	}
+	if( sock->_reconnect ) {
+		sock->_addresses = address_list;
+	} else {
+		ts_resolver_release( address_list );
+	}
+#endif
+
+	// return status
+	return _ts_connect_result( sock, status );
+}
+
+static TsStatus_t ts_disconnect( TsDriverRef_t driver ) {
+
+	ts_status_trace( "ts_driver_disconnect\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+
+	// an explicit disconnect ends reconnecting, the held writes are dropped, the callback
+	// is told before the descriptor is closed
+	sock->_queue_used = 0;
+	sock->_attempts = 0;
+	_ts_reconnect_enter( sock, TsDriverUnixStateIdle );
+	_ts_close( sock );
+	ts_resolver_release( sock->_addresses );
+	sock->_addresses = NULL;
+
+	return TsStatusOk;
+}
+
+/**
+ * Start a reconnect attempt, a non-blocking connect to the next of the addresses resolved
+ * at connect (local sockets connect right away). Completed by _ts_reconnect_tick.
+ */
+static void _ts_reconnect_start( TsDriverSocketRef_t sock ) {
+
+	_ts_reconnect_enter( sock, TsDriverUnixStateConnecting );
+	sock->_attempt_at = ts_platform_time();
+
+	if( strncmp( sock->_address, TS_DRIVER_UNIX_LOCAL, sizeof( TS_DRIVER_UNIX_LOCAL ) - 1 ) == 0 ) {
+		_ts_connect_result( sock, _ts_connect_local( sock, sock->_address + sizeof( TS_DRIVER_UNIX_LOCAL ) - 1 ));
+		return;
+	}
+
+	if( sock->_addresses == NULL ) {
+		_ts_connect_result( sock, TsStatusErrorNotFound );
+		return;
+	}
+
+	// the schedule counted this attempt already, the first one takes the first address
+	uint32_t count = 0;
+	for( struct addrinfo * current = sock->_addresses; current != NULL; current = current->ai_next ) {
+		count = count + 1;
+	}
+	struct addrinfo * current = sock->_addresses;
+	for( uint32_t i = 0; i < ( sock->_attempts - 1 ) % count; i++ ) {
+		current = current->ai_next;
+	}
+
+	TsStatus_t status = TsStatusErrorBadGateway;
+	int fd = (int) socket( current->ai_family, current->ai_socktype, current->ai_protocol );
+	if( fd >= 0 && fcntl( fd, F_SETFL, fcntl( fd, F_GETFL, 0 ) | O_NONBLOCK ) != -1 ) {
+		_ts_apply_profile( sock, fd );
+		if( connect( fd, current->ai_addr, current->ai_addrlen ) == 0 ) {
+			sock->_fd = fd;
+			status = TsStatusOk;
+		} else if( errno == EINPROGRESS ) {
+			sock->_fd = fd;
+			status = TsStatusOkWritePending;
+		} else {
+			ts_status_debug( "ts_driver_reconnect: attempt failed, %d\n", errno );
+			close( fd );
+		}
+	} else if( fd >= 0 ) {
+		close( fd );
+	}
+
+	if( status != TsStatusOkWritePending ) {
+		_ts_connect_result( sock, status );
+	}
+}
+
+/**
+ * Advance the reconnect state machine: start the next attempt when its time has come, and
+ * complete (or time out) the one in progress. Once connected, send what is still held.
+ */
+static void _ts_reconnect_tick( TsDriverSocketRef_t sock ) {
+
+	if( sock->_state == TsDriverUnixStateBackoff && ts_platform_time() >= sock->_attempt_at ) {
+		_ts_reconnect_start( sock );
+	}
+
+	if( sock->_state == TsDriverUnixStateConnecting ) {
+
+		struct pollfd descriptor;
+		descriptor.fd = sock->_fd;
+		descriptor.events = POLLOUT;
+		descriptor.revents = 0;
+		if( poll( &descriptor, 1, 0 ) > 0 ) {
+
+			int error = 0;
+			socklen_t length = sizeof( error );
+			if( getsockopt( sock->_fd, SOL_SOCKET, SO_ERROR, &error, &length ) == 0 && error == 0 ) {
+				_ts_connect_result( sock, TsStatusOk );
+			} else {
+				ts_status_debug( "ts_driver_reconnect: attempt failed, %d\n", error );
+				_ts_close( sock );
+				_ts_connect_result( sock, TsStatusErrorBadGateway );
+			}
+
+		} else if( ts_platform_time() - sock->_attempt_at > sock->_driver._spec_budget ) {
+
+			ts_status_debug( "ts_driver_reconnect: attempt timed out\n" );
+			_ts_close( sock );
+			_ts_connect_result( sock, TsStatusErrorBadGateway );
+		}
+	}
+
+	if( sock->_state == TsDriverUnixStateConnected && sock->_queue_used > 0 ) {
+		_ts_reconnect_check( sock, _ts_queue_flush( sock ));
+	}
+}
+
+/**
+ * Wait for the socket to become readable within what is left of the read budget.
+ * Returns true when there is something to read (or an error to collect).
+ */
+static bool _ts_read_wait( TsDriverSocketRef_t sock, uint64_t timestamp, uint32_t budget ) {
+
+#if defined(TS_DRIVER_SOCKET_URING)
+	if( _ts_uring_used( sock )) {
+		return _ts_uring_wait( sock, timestamp, budget );
+	}
+#endif
+
+	struct pollfd descriptor;
+	descriptor.fd = sock->_fd;
+	descriptor.events = POLLIN;
+	descriptor.revents = 0;
+
+	int result;
+	do {
+		uint64_t elapsed = ts_platform_time() - timestamp;
+		if( elapsed >= budget ) {
+			return false;
+		}
+		// poll has millisecond resolution, round up so the budget is not cut short
+		int timeout = (int) (( budget - elapsed + 999 ) / 1000 );
+		result = poll( &descriptor, 1, timeout );
+	} while( result < 0 && errno == EINTR );
+
+	return result > 0;
+}
+
+/**
+ * Read from the socket driver (non-blocking). Note that we dont use select() in order to emulate
+ * the other channels better, e.g., uart and usb.
+ *
+ * When the read wait mode is enabled (see ts_driver_unix_read_wait), an empty socket is instead
+ * waited on with poll() for up to the budget, and the first bytes are returned as soon as they
+ * arrive, together with everything else available at that moment.
+ *
+ * A datagram connection returns one datagram per read, truncated to the buffer.
+ *
+ * @note
+ * TsStatusOkReadPending has a very specific meaning, only return when the read
+ * has returned pending and there isn't data in the buffer, in all other cases
+ * return a valid status with the contents of the current buffer.
+ *
+ * @param driver
+ * [in] The socket state
+ *
+ * @param buffer
+ * [in] The pre-allocated buffer memory
+ *
+ * @param buffer_size
+ * [in] The pre-allocated buffer memory size
+ * [out] The actual number of byte read
+ *
+ * @param budget
+ * [in] Recommended allotment of time in microseconds allowed wait for received bytes.
+ *
+ * @return
+ * TsStatusOk, *buffer_size > 0 - Return the given amount of read data
+ * TsStatusOk, *buffer_size = 0 - Usually indicates and end-of-file condition
+ * TsStatusOkPendingRead        - Indicates a blocking condition exists (and avoided),
+ *                                note, *buffer_size is guaranteed to be zero when this condition occurs.
+ *                                In read wait mode, the budget was exhausted without data arriving.
+ * TsStatusErrorConnectionReset - Indicates that the driver was broken
+ * TsStatusError*               - Indicates an error has occurred, see ts_status.h for more information.
+ */
+static TsStatus_t ts_read( TsDriverRef_t driver, const uint8_t * buffer, size_t * buffer_size, uint32_t budget ) {
+
+	ts_status_trace( "ts_driver_read\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( buffer != NULL );
+	ts_platform_assert( buffer_size != NULL );
+	ts_platform_assert( *buffer_size > 0 );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+
+	// initialize timestamp for read timer budgeting
+	uint64_t timestamp = ts_platform_time();
+
+	// limit read to 1MHz call bandwidth
+	// note that this doesnt limit the number of recv calls made below,
+	// just the number of reattempts by the caller,...
+	// (not needed when waiting, the caller isnt spinning)
+	if( !sock->_read_wait && timestamp - sock->_last_read_timestamp == 0 ) {
+		*buffer_size = 0;
+		_ts_stats_read( sock, timestamp, 0, TsStatusOkReadPending );
+		return TsStatusOkReadPending;
+	}
+	sock->_last_read_timestamp = timestamp;
+
+	if( _ts_reconnecting( sock )) {
+		*buffer_size = 0;
+		_ts_stats_read( sock, timestamp, 0, TsStatusOkReadPending );
+		return TsStatusOkReadPending;
+	}
+	if( sock->_datagram ) {
+		TsStatus_t status = _ts_datagram_read( sock, (uint8_t *) buffer, buffer_size, timestamp, budget );
+		_ts_stats_read( sock, timestamp, *buffer_size, status );
+		return _ts_reconnect_check( sock, status );
+	}
+
+	// perform read
+	int flags = 0x00;
+	bool reading = true;
+	ssize_t index = 0;
+	TsStatus_t status = TsStatusOk;
+	do {
+
+		// read from the socket
+		ssize_t size = _ts_recv( sock, (void *) ( buffer + index ), ( *buffer_size ) - index, flags );
+		_ts_stats_count( sock, _read_syscalls, 1 );
+		if( size < 0 ) {
+
+			// recv has indicated either non-block status
+			// or an actual driver issue,...
+			size = 0;
+			reading = false;
+
+			// establish the exit scenario for the caller
+			if( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) {
+				if( index > 0 ) {
+					status = TsStatusOk;
+				} else if( sock->_read_wait && _ts_read_wait( sock, timestamp, budget )) {
+					// data arrived within the budget, drain it
+					reading = true;
+				} else {
+					status = TsStatusOkReadPending;
+				}
+			} else if( errno == EPIPE || errno == ECONNRESET ) {
+				status = TsStatusErrorConnectionReset;
+			} else if( errno != 0 ) {
+				ts_status_debug( "ts_driver_read: ignoring error, %d\n", errno );
+				status = TsStatusErrorInternalServerError;
+			}
+
+		} else if( size == 0 ) {
+
+			// first normal exit condition, non-block io read returns zero bytes
+			// (end-of-file, which means the connection is lost when reconnecting)
+			reading = false;
+			status = ( sock->_reconnect && index == 0 ) ? TsStatusErrorConnectionReset : TsStatusOk;
+
+		} else if( ts_platform_time() - timestamp > budget ) {
+
+			// there is more to read than expected on this attempt,
+			// give back control to caller
+			ts_status_debug( "ts_driver_read: timer budget exceeded\n" );
+			_ts_stats_count( sock, _budget_overruns, 1 );
+			reading = false;
+
+			if( index > 0 ) {
+				status = TsStatusOk;
+			} else {
+				status = TsStatusOkReadPending;
+			}
+		}
+
+		index = index + size;
+
+		if( index >= *buffer_size ) {
 			// second normal exit condition, the buffer is full
+			reading = false;
+			status = TsStatusOk;
+		}
+
+	} while( reading );
+
+	// update read buffer size and return
+	*buffer_size = (size_t) index;
+	_ts_stats_read( sock, timestamp, *buffer_size, status );
+	return _ts_reconnect_check( sock, status );
+}
+
+/**
+ * Register the given reader, which ts_tick will call with the data as it arrives. Registering
+ * NULL returns the driver to pull style reading via ts_read.
+ */
+static TsStatus_t ts_reader( TsDriverRef_t driver, void * data, TsDriverReader_t reader ) {
+
+	ts_status_trace( "ts_driver_reader\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( reader != NULL && sock->_reader_buffer == NULL ) {
+		sock->_reader_buffer = (uint8_t *) ts_platform_malloc( sock->_driver._spec_mtu );
+		if( sock->_reader_buffer == NULL ) {
+			return TsStatusErrorInternalServerError;
+		}
+	} else if( reader == NULL && sock->_reader_buffer != NULL ) {
+		ts_platform_free( sock->_reader_buffer, sock->_driver._spec_mtu );
+		sock->_reader_buffer = NULL;
+	}
+	sock->_driver._reader = reader;
+	sock->_driver._reader_state = data;
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_write( TsDriverRef_t driver, const uint8_t * buffer, size_t * buffer_size, uint32_t budget ) {
+
+	ts_status_trace( "ts_driver_write\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( buffer != NULL );
+	ts_platform_assert( buffer_size != NULL );
+	ts_platform_assert( *buffer_size > 0 );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+
+	// initialize timestamp for write timer budgeting
+	uint64_t timestamp = ts_platform_time();
+
+	if( _ts_queue_hold( sock )) {
+		struct iovec local;
+		local.iov_base = (void *) buffer;
+		local.iov_len = *buffer_size;
+		size_t size = *buffer_size;
+		TsStatus_t status = _ts_queue_append( sock, &local, 1, &size );
+		*buffer_size = size;
+		return status;
+	}
+	if( sock->_datagram ) {
+		struct iovec local;
+		local.iov_base = (void *) buffer;
+		local.iov_len = *buffer_size;
+		TsStatus_t status = _ts_datagram_write( sock, &local, 1, *buffer_size );
+		size_t size = ( status == TsStatusOk ) ? *buffer_size : 0;
+		_ts_stats_write( sock, timestamp, size, *buffer_size, status );
+		*buffer_size = size;
+		return _ts_reconnect_check( sock, status );
+	}
+
+	// perform write
+	int flags = 0x00;
+	bool writing = true;
+	ssize_t index = 0;
+	TsStatus_t status = TsStatusOk;
+	do {
+
+		// write to the socket
+		struct iovec local;
+		struct msghdr message;
+		memset( &message, 0x00, sizeof( message ));
+		local.iov_base = (void *) ( buffer + index );
+		local.iov_len = *buffer_size - index;
+		message.msg_iov = &local;
+		message.msg_iovlen = 1;
+		ssize_t size = _ts_sendmsg( sock, &message, local.iov_len, flags );
+		_ts_stats_count( sock, _write_syscalls, 1 );
+		if( size < 0 ) {
+
+			// send has indicated either non-block status
+			// or an actual driver issue,...
+			size = 0;
+			writing = false;
+
+			// establish exit scenarip for the caller
+			if( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) {
+				if( index > 0 ) {
+					status = TsStatusOk;
+				} else {
+					status = TsStatusOkWritePending;
+				}
+			} else if( errno == EPIPE || errno == ECONNRESET ) {
+				status = TsStatusErrorConnectionReset;
+			} else if( errno != 0 ) {
+				ts_status_debug( "ts_driver_write: ignoring error, %d\n", errno );
+				status = TsStatusErrorInternalServerError;
+			}
+
+		} else if( size == 0 ) {
+
+			// unexpected non-blocking call returns zero bytes
+			ts_status_info( "ts_driver_write: unexpected empty write occured\n" );
+			writing = false;
+			if( index > 0 ) {
+				status = TsStatusOk;
+			} else {
+				status = TsStatusOkWritePending;
+			}
+
+		} else if( ts_platform_time() - timestamp > budget ) {
+
+			// there is more to write, but dont give control back to the caller
+			ts_status_debug( "ts_driver_write: ignoring timer budget exceeded\n" );
+			_ts_stats_count( sock, _budget_overruns, 1 );
+		}
+
+		index = index + size;
+
+		if( index >= *buffer_size ) {
+
+			// second normal exit condition, the buffer is full
+			writing = false;
+			status = TsStatusOk;
+		}
+
+	} while( writing );
+
+	// update write buffer size and return
+	_ts_stats_write( sock, timestamp, (size_t) index, *buffer_size, status );
+	*buffer_size = (size_t) index;
+	return _ts_reconnect_check( sock, status );
+}
+
+// build a local vector for the part of the given vector that is still to be written,
+// i.e., skip the first offset bytes, resuming mid-element where needed
+static int _ts_iov_advance( const struct iovec * vector, int count, size_t offset, struct iovec * local ) {
+
+	int index = 0;
+	for( int i = 0; i < count && index < TS_DRIVER_UNIX_IOV_MAX; i++ ) {
+		if( offset >= vector[ i ].iov_len ) {
+			offset = offset - vector[ i ].iov_len;
+			continue;
+		}
+		local[ index ].iov_base = (uint8_t *) vector[ i ].iov_base + offset;
+		local[ index ].iov_len = vector[ i ].iov_len - offset;
+		offset = 0;
+		index = index + 1;
+	}
+	return index;
+}
+
+TsStatus_t ts_driver_unix_writev( TsDriverRef_t driver, const struct iovec * vector, int count, size_t * written, uint32_t budget ) {
+
+	ts_status_trace( "ts_driver_writev\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( vector != NULL );
+	ts_platform_assert( written != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+
+	// initialize timestamp for write timer budgeting
+	uint64_t timestamp = ts_platform_time();
+
+	size_t total = 0;
+	for( int i = 0; i < count; i++ ) {
+		total = total + vector[ i ].iov_len;
+	}
+	if( *written >= total ) {
+		return TsStatusOk;
+	}
+	if( _ts_queue_hold( sock )) {
+		struct iovec held[ TS_DRIVER_UNIX_IOV_MAX ];
+		size_t size = total - *written;
+		TsStatus_t status = _ts_queue_append( sock, held, _ts_iov_advance( vector, count, *written, held ), &size );
+		*written = *written + size;
+		return status;
+	}
+	if( sock->_datagram ) {
+		// the vector is one datagram, sent whole or not at all
+		TsStatus_t status = _ts_datagram_write( sock, vector, count, total );
+		*written = ( status == TsStatusOk ) ? total : 0;
+		_ts_stats_write( sock, timestamp, *written, total, status );
+		return _ts_reconnect_check( sock, status );
+	}
+#if defined(TS_DRIVER_SOCKET_URING)
+	if( _ts_uring_used( sock )) {
+		// the ring owns the socket, see _ts_uring_send
+		size_t size = 0;
+		TsStatus_t status = _ts_uring_send( sock, vector, count, *written, &size, timestamp, budget );
+		_ts_stats_write( sock, timestamp, size, total - *written, status );
+		*written = *written + size;
+		return status;
+	}
+#endif
+
+	// perform write
+	int flags = 0x00;
+	bool writing = true;
+	size_t index = *written;
+	struct iovec local[ TS_DRIVER_UNIX_IOV_MAX ];
+	TsStatus_t status = TsStatusOk;
+	do {
+
+		// write to the socket
+		struct msghdr message;
+		memset( &message, 0x00, sizeof( message ));
+		message.msg_iov = local;
+		message.msg_iovlen = _ts_iov_advance( vector, count, index, local );
+		ssize_t size = _ts_sendmsg( sock, &message, total - index, flags );
+		_ts_stats_count( sock, _write_syscalls, 1 );
+		if( size < 0 ) {
+
+			// write has indicated either non-block status
+			// or an actual driver issue,...
+			size = 0;
+			writing = false;
+
+			// establish exit scenario for the caller
+			if( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) {
+				if( index > *written ) {
+					status = TsStatusOk;
+				} else {
+					status = TsStatusOkWritePending;
+				}
+			} else if( errno == EPIPE || errno == ECONNRESET ) {
+				status = TsStatusErrorConnectionReset;
+			} else if( errno != 0 ) {
+				ts_status_debug( "ts_driver_writev: ignoring error, %d\n", errno );
+				status = TsStatusErrorInternalServerError;
+			}
+
+		} else if( size == 0 ) {
+
+			// unexpected non-blocking call returns zero bytes
+			ts_status_info( "ts_driver_writev: unexpected empty write occured\n" );
+			writing = false;
+			if( index > *written ) {
+				status = TsStatusOk;
+			} else {
+				status = TsStatusOkWritePending;
+			}
+
+		} else if( ts_platform_time() - timestamp > budget ) {
+
+			// there is more to write, but dont give control back to the caller
+			ts_status_debug( "ts_driver_writev: ignoring timer budget exceeded\n" );
+			_ts_stats_count( sock, _budget_overruns, 1 );
+		}
+
+		index = index + (size_t) size;
+
+		if( index >= total ) {
+
+			// second normal exit condition, the vector is written
 			writing = false;
 			status = TsStatusOk;
 		}
 
-	} while( writing );
+	} while( writing );
+
+	// update the written size and return
+	_ts_stats_write( sock, timestamp, index - *written, total - *written, status );
+	*written = index;
+	return _ts_reconnect_check( sock, status );
+}
+
+int ts_driver_unix_fd( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+#if defined(TS_DRIVER_SOCKET_URING)
+	if( sock->_fd >= 0 && _ts_uring_used( sock )) {
+		return _ts_uring_fd( sock );
+	}
+#endif
+	return sock->_fd;
+}
+
+TsStatus_t ts_driver_unix_read_wait( TsDriverRef_t driver, bool wait ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	sock->_read_wait = wait;
+
+	return TsStatusOk;
+}
+
+TsStatus_t ts_driver_unix_profile( TsDriverRef_t driver, const TsDriverUnixProfile_t * profile ) {
+
+	ts_status_trace( "ts_driver_profile\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( profile != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	sock->_unix_profile = *profile;
+	if( sock->_fd >= 0 ) {
+		_ts_apply_profile( sock, sock->_fd );
+	}
+
+	return TsStatusOk;
+}
+
+TsStatus_t ts_driver_unix_profile_effective( TsDriverRef_t driver, TsDriverUnixProfile_t * profile ) {
+
+	ts_status_trace( "ts_driver_profile_effective\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( profile != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	*profile = sock->_unix_profile;
+	if( sock->_fd < 0 ) {
+		return TsStatusErrorNotFound;
+	}
+
+	int fd = sock->_fd;
+	profile->_nodelay = _ts_get_option( fd, IPPROTO_TCP, TCP_NODELAY ) != 0;
+	profile->_rcvbuf = _ts_get_option( fd, SOL_SOCKET, SO_RCVBUF );
+	profile->_sndbuf = _ts_get_option( fd, SOL_SOCKET, SO_SNDBUF );
+	profile->_keepalive_idle = 0;
+	if( _ts_get_option( fd, SOL_SOCKET, SO_KEEPALIVE ) != 0 ) {
+#if defined(TCP_KEEPIDLE)
+		profile->_keepalive_idle = (uint32_t) _ts_get_option( fd, IPPROTO_TCP, TCP_KEEPIDLE );
+#elif defined(TCP_KEEPALIVE)
+		profile->_keepalive_idle = (uint32_t) _ts_get_option( fd, IPPROTO_TCP, TCP_KEEPALIVE );
+#endif
+	}
+#if defined(TCP_KEEPINTVL)
+	profile->_keepalive_interval = (uint32_t) _ts_get_option( fd, IPPROTO_TCP, TCP_KEEPINTVL );
+#endif
+#if defined(TCP_KEEPCNT)
+	profile->_keepalive_count = (uint32_t) _ts_get_option( fd, IPPROTO_TCP, TCP_KEEPCNT );
+#endif
+#if defined(TCP_USER_TIMEOUT)
+	profile->_user_timeout = (uint32_t) _ts_get_option( fd, IPPROTO_TCP, TCP_USER_TIMEOUT );
+#endif
+#if defined(SO_BUSY_POLL)
+	profile->_busy_poll = (uint32_t) _ts_get_option( fd, SOL_SOCKET, SO_BUSY_POLL );
+#endif
+	struct sockaddr_storage local;
+	socklen_t length = sizeof( local );
+	if( getsockname( fd, (struct sockaddr *) &local, &length ) == 0 && local.ss_family == AF_INET6 ) {
+		profile->_tos = _ts_get_option( fd, IPPROTO_IPV6, IPV6_TCLASS );
+	} else {
+		profile->_tos = _ts_get_option( fd, IPPROTO_IP, IP_TOS );
+	}
+
+	return TsStatusOk;
+}
+
+TsStatus_t ts_driver_unix_zerocopy( TsDriverRef_t driver, TsDriverUnixCompletion_t callback, void * state ) {
+
+	ts_status_trace( "ts_driver_zerocopy\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	sock->_zerocopy_callback = callback;
+	sock->_zerocopy_state = state;
+
+	return TsStatusOk;
+}
+
+uint32_t ts_driver_unix_zerocopy_sequence( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	return sock->_zerocopy_next;
+}
+
+TsStatus_t ts_driver_unix_reconnect( TsDriverRef_t driver, TsDriverUnixStateCallback_t callback, void * state ) {
+
+	ts_status_trace( "ts_driver_reconnect\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	sock->_reconnect_callback = callback;
+	sock->_reconnect_state = state;
+
+	return TsStatusOk;
+}
+
+TsDriverUnixState_t ts_driver_unix_state( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	return sock->_state;
+}
+
+TsStatus_t ts_driver_unix_send_fd( TsDriverRef_t driver, int fd, const uint8_t * buffer, size_t * buffer_size ) {
+
+	ts_status_trace( "ts_driver_send_fd\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( buffer != NULL );
+	ts_platform_assert( buffer_size != NULL );
+	ts_platform_assert( *buffer_size > 0 );
+
+	// only local connections pass descriptors, and those never use the io_uring backend
+	// (see _ts_uring_used), so the socket is not shared with requests in flight
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( !sock->_local ) {
+		*buffer_size = 0;
+		return TsStatusErrorNotImplemented;
+	}
+
+	// descriptors are not held, while reconnecting (or held writes remain) try again later
+	if( _ts_queue_hold( sock )) {
+		*buffer_size = 0;
+		return TsStatusOkWritePending;
+	}
+	if( sock->_fd < 0 ) {
+		*buffer_size = 0;
+		return TsStatusErrorNotImplemented;
+	}
+
+#if defined(TS_DRIVER_STATS)
+	// the call latency is recorded, there is no budget
+	uint64_t timestamp = ts_platform_time();
+#endif
+
+	union {
+		char buffer[ CMSG_SPACE( sizeof( int )) ];
+		struct cmsghdr align;
+	} control;
+	memset( &control, 0x00, sizeof( control ));
+	struct iovec vector;
+	vector.iov_base = (void *) buffer;
+	vector.iov_len = *buffer_size;
+	struct msghdr message;
+	memset( &message, 0x00, sizeof( message ));
+	message.msg_iov = &vector;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof( control.buffer );
+	struct cmsghdr * header = CMSG_FIRSTHDR( &message );
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN( sizeof( int ));
+	memcpy( CMSG_DATA( header ), &fd, sizeof( int ));
+
+	ssize_t size;
+	do {
+		size = sendmsg( sock->_fd, &message, MSG_NOSIGNAL );
+		_ts_stats_count( sock, _write_syscalls, 1 );
+	} while( size < 0 && errno == EINTR );
+
+	TsStatus_t status = TsStatusOk;
+	if( size < 0 ) {
+		size = 0;
+		if( errno == EWOULDBLOCK || errno == EAGAIN ) {
+			status = TsStatusOkWritePending;
+		} else if( errno == EPIPE || errno == ECONNRESET ) {
+			status = TsStatusErrorConnectionReset;
+		} else {
+			ts_status_debug( "ts_driver_send_fd: ignoring error, %d\n", errno );
+			status = TsStatusErrorInternalServerError;
+		}
+	}
+
+	_ts_stats_write( sock, timestamp, (size_t) size, *buffer_size, status );
+	*buffer_size = (size_t) size;
+	return _ts_reconnect_check( sock, status );
+}
+
+int ts_driver_unix_receive_fd( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( sock->_fds_count == 0 ) {
+		return -1;
+	}
+	int fd = sock->_fds[ 0 ];
+	sock->_fds_count = sock->_fds_count - 1;
+	memmove( sock->_fds, sock->_fds + 1, (size_t) sock->_fds_count * sizeof( int ));
+	return fd;
+}
+
+TsStatus_t ts_driver_unix_flush( TsDriverRef_t driver ) {
+
+	ts_status_trace( "ts_driver_flush\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( sock->_fd >= 0 && sock->_datagram ) {
+		return _ts_datagram_flush( sock );
+	}
+	if( sock->_fd < 0 || !sock->_unix_profile._cork ) {
+		return TsStatusOk;
+	}
+
+	// releasing the cork sends the partial segment now, then cork the next batch
+	int off = 0, on = 1;
+#if defined(TCP_CORK)
+	if( setsockopt( sock->_fd, IPPROTO_TCP, TCP_CORK, &off, sizeof( off )) < 0 ||
+		setsockopt( sock->_fd, IPPROTO_TCP, TCP_CORK, &on, sizeof( on )) < 0 ) {
+		ts_status_debug( "ts_driver_flush: TCP_CORK error, %d\n", errno );
+		return TsStatusErrorInternalServerError;
+	}
+#elif defined(TCP_NOPUSH)
+	// note, bsd only pushes the held data with the next send after clearing TCP_NOPUSH
+	if( setsockopt( sock->_fd, IPPROTO_TCP, TCP_NOPUSH, &off, sizeof( off )) < 0 ||
+		send( sock->_fd, NULL, 0, MSG_NOSIGNAL ) < 0 ||
+		setsockopt( sock->_fd, IPPROTO_TCP, TCP_NOPUSH, &on, sizeof( on )) < 0 ) {
+		ts_status_debug( "ts_driver_flush: TCP_NOPUSH error, %d\n", errno );
+		return TsStatusErrorInternalServerError;
+	}
+#endif
+
+	return TsStatusOk;
+}
+
+/**
+ * Allocate the receive ring. On linux the ring memory is mapped twice, back to back, so that
+ * the unread bytes are always contiguous even when they wrap; elsewhere (or when that fails)
+ * the ring is a linear buffer that is compacted when its end is reached.
+ */
+static TsStatus_t _ts_ring_create( TsDriverSocketRef_t sock ) {
+
+	size_t page = (size_t) sysconf( _SC_PAGESIZE );
+	size_t size = ( TS_DRIVER_UNIX_RING_SIZE + page - 1 ) / page * page;
+
+#if defined(__linux__) && defined(SYS_memfd_create)
+	int fd = (int) syscall( SYS_memfd_create, "ts_driver_ring", 0 );
+	if( fd >= 0 && ftruncate( fd, (off_t) size ) == 0 ) {
+		uint8_t * base = (uint8_t *) mmap( NULL, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+		if( base != MAP_FAILED &&
+			mmap( base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) != MAP_FAILED &&
+			mmap( base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0 ) != MAP_FAILED ) {
+			close( fd );
+			sock->_ring = base;
+			sock->_ring_size = size;
+			sock->_ring_mirrored = true;
+			return TsStatusOk;
+		}
+		if( base != MAP_FAILED ) {
+			munmap( base, 2 * size );
+		}
+	}
+	if( fd >= 0 ) {
+		close( fd );
+	}
+	ts_status_debug( "ts_driver_peek: mirrored ring not available, %d\n", errno );
+#endif
+
+	sock->_ring = (uint8_t *) ts_platform_malloc( size );
+	if( sock->_ring == NULL ) {
+		return TsStatusErrorInternalServerError;
+	}
+	sock->_ring_size = size;
+	sock->_ring_mirrored = false;
+	return TsStatusOk;
+}
+
+TsStatus_t ts_driver_unix_peek( TsDriverRef_t driver, const uint8_t ** view, size_t * size, uint32_t budget ) {
+
+	ts_status_trace( "ts_driver_peek\n" );
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( view != NULL );
+	ts_platform_assert( size != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( sock->_datagram ) {
+		return TsStatusErrorNotImplemented;
+	}
+	if( _ts_reconnecting( sock )) {
+		*view = sock->_ring;
+		*size = 0;
+		return TsStatusOkReadPending;
+	}
+	if( sock->_ring == NULL && _ts_ring_create( sock ) != TsStatusOk ) {
+		return TsStatusErrorInternalServerError;
+	}
+
+	// initialize timestamp for read timer budgeting
+	uint64_t timestamp = ts_platform_time();
+
+	bool reading = true;
+	TsStatus_t status = TsStatusOk;
+	while( reading ) {
+
+		// make room at the end of a linear ring
+		if( !sock->_ring_mirrored && sock->_ring_tail == sock->_ring_size && sock->_ring_head > 0 ) {
+			memmove( sock->_ring, sock->_ring + sock->_ring_head, sock->_ring_tail - sock->_ring_head );
+			sock->_ring_tail = sock->_ring_tail - sock->_ring_head;
+			sock->_ring_head = 0;
+		}
+		size_t unread = sock->_ring_tail - sock->_ring_head;
+		size_t space = sock->_ring_mirrored ? sock->_ring_size - unread : sock->_ring_size - sock->_ring_tail;
+		if( space == 0 ) {
+			break;
+		}
+
+		ssize_t received = _ts_recv( sock, sock->_ring + sock->_ring_tail, space, 0 );
+		_ts_stats_count( sock, _read_syscalls, 1 );
+		if( received > 0 ) {
+
+			_ts_stats_count( sock, _bytes_in, (size_t) received );
+
+			sock->_ring_tail = sock->_ring_tail + (size_t) received;
+
+		} else if( received == 0 ) {
+
+			// orderly shutdown by the peer, reported once the unread bytes are released
+			reading = false;
+			if( unread == 0 ) {
+				status = TsStatusErrorConnectionReset;
+			}
+
+		} else if( errno == EINTR ) {
+
+			continue;
+
+		} else if( errno == EWOULDBLOCK || errno == EAGAIN ) {
+
+			reading = false;
+			if( unread == 0 ) {
+				if( sock->_read_wait && _ts_read_wait( sock, timestamp, budget )) {
+					reading = true;
+				} else {
+					status = TsStatusOkReadPending;
+				}
+			}
+
+		} else {
+
+			reading = false;
+			if( unread > 0 ) {
+				// report on the next call
+			} else if( errno == EPIPE || errno == ECONNRESET ) {
+				status = TsStatusErrorConnectionReset;
+			} else {
+				ts_status_debug( "ts_driver_peek: ignoring error, %d\n", errno );
+				status = TsStatusErrorInternalServerError;
+			}
+		}
+
+		if( reading && ts_platform_time() - timestamp > budget ) {
+			ts_status_debug( "ts_driver_peek: timer budget exceeded\n" );
+			_ts_stats_count( sock, _budget_overruns, 1 );
+			reading = false;
+		}
+	}
+
+	*view = sock->_ring + sock->_ring_head;
+	*size = sock->_ring_tail - sock->_ring_head;
+	_ts_stats_read( sock, timestamp, 0, status );
+	return _ts_reconnect_check( sock, status );
+}
+
+TsStatus_t ts_driver_unix_release( TsDriverRef_t driver, size_t size ) {
+
+	ts_status_trace( "ts_driver_release\n" );
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( size > sock->_ring_tail - sock->_ring_head ) {
+		return TsStatusErrorBadRequest;
+	}
+
+	sock->_ring_head = sock->_ring_head + size;
+	if( sock->_ring_head == sock->_ring_tail ) {
+		// empty, start over at the front
+		sock->_ring_head = 0;
+		sock->_ring_tail = 0;
+	} else if( sock->_ring_mirrored && sock->_ring_head >= sock->_ring_size ) {
+		// the unread bytes are in the mirror, move back to the first mapping
+		sock->_ring_head = sock->_ring_head - sock->_ring_size;
+		sock->_ring_tail = sock->_ring_tail - sock->_ring_size;
+	}
+
+	return TsStatusOk;
+}
+
+#if defined(TS_DRIVER_STATS)
+TsStatus_t ts_driver_unix_stats( TsDriverRef_t driver, TsDriverUnixStats_t * stats ) {
+
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( stats != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	*stats = sock->_stats;
+
+	return TsStatusOk;
+}
+
+TsStatus_t ts_driver_unix_stats_reset( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	memset( &( sock->_stats ), 0x00, sizeof( TsDriverUnixStats_t ));
+
+	return TsStatusOk;
+}
+
+#endif
+
+#if defined(TS_DRIVER_SOCKET_URING)
+
+// io_uring backend
+//
+// a ring per driver, driven with the raw system calls. while connected, a multishot
+// receive stays armed and fills buffers provided to the kernel, so a read only looks
+// at the completion queue in shared memory and makes no system call unless it waits.
+// writes are copied into a write buffer and submitted as SEND with MSG_NOSIGNAL (a
+// WRITE to a reset peer raises SIGPIPE, as write(2) does), the write waits for the
+// completion (within its budget) so that it reports what was sent, as the socket
+// calls do. the ring owns the socket, every read and write of the driver
+// (writev and peek included) goes through it, and the ring's descriptor is the one to
+// wait on, see ts_driver_unix_fd. when the kernel lacks a required feature the plain
+// socket calls are used instead.
+
+#ifndef TS_DRIVER_URING_BUFFERS
+#define TS_DRIVER_URING_BUFFERS 16           // provided receive buffers, a power of two
+#endif
+#ifndef TS_DRIVER_URING_BUFFER_SIZE
+#define TS_DRIVER_URING_BUFFER_SIZE 4096
+#endif
+#ifndef TS_DRIVER_URING_WRITE_SIZE
+#define TS_DRIVER_URING_WRITE_SIZE 65536     // write buffer
+#endif
+#define TS_DRIVER_URING_ENTRIES 8
+#define TS_DRIVER_URING_COMPLETIONS ( 4 * TS_DRIVER_URING_BUFFERS )
+#define TS_DRIVER_URING_GROUP 0
+#define TS_DRIVER_URING_RX 1
+#define TS_DRIVER_URING_TX 2
+#define TS_DRIVER_URING_CANCEL 3
+#define TS_DRIVER_URING_SIGNAL 4
+#define TS_DRIVER_URING_WRITABLE 5
+#define TS_DRIVER_URING_DRAIN 100000         // microseconds to wait for cancelled requests
+
+typedef struct TsDriverUring * TsDriverUringRef_t;
+typedef struct TsDriverUring {
+
+	int _fd;
+	void * _ring;
+	size_t _ring_size;
+	struct io_uring_sqe * _sqes;
+	size_t _sqes_size;
+
+	// submission queue
+	unsigned * _sq_head;
+	unsigned * _sq_tail;
+	unsigned * _sq_mask;
+	unsigned * _sq_array;
+	unsigned * _sq_flags;
+	unsigned _sq_entries;
+	unsigned _sq_pending;   // prepared but not yet submitted
+
+	// completion queue
+	unsigned * _cq_head;
+	unsigned * _cq_tail;
+	unsigned * _cq_mask;
+	struct io_uring_cqe * _cqes;
+
+	// multishot receive into provided buffers
+	struct io_uring_buf_ring * _buf_ring;
+	size_t _buf_ring_size;
+	uint16_t _buf_tail;
+	uint8_t * _buffers;
+	bool _receiving;
+	bool _starved;                                      // every buffer was held by the reader
+	uint16_t _ready[ TS_DRIVER_URING_BUFFERS ];         // received buffers in order
+	uint32_t _ready_size[ TS_DRIVER_URING_BUFFERS ];
+	size_t _ready_head;
+	size_t _ready_count;
+	size_t _ready_offset;                               // consumed from the first buffer
+	TsStatus_t _rx_status;                              // reported once the data is read
+
+	// write from the write buffer
+	uint8_t * _write_buffer;
+	size_t _write_offset;
+	size_t _write_size;
+	bool _writing;
+	bool _write_cancel;     // the rest of the write is not resubmitted
+	TsStatus_t _tx_status;
+
+	// readiness of the ring's descriptor, see _ts_uring_signal
+	bool _signalled;        // a no-op is in flight
+	bool _polling;          // a poll for the socket's writability is in flight
+
+} TsDriverUring_t;
+
+static int _ts_uring_enter( TsDriverUringRef_t uring, unsigned submit, unsigned complete, uint32_t timeout ) {
+
+	if( complete == 0 ) {
+		return (int) syscall( __NR_io_uring_enter, uring->_fd, submit, 0, IORING_ENTER_GETEVENTS, NULL, 0 );
+	}
+
+	struct __kernel_timespec deadline;
+	deadline.tv_sec = timeout / TS_TIME_SEC_TO_USEC;
+	deadline.tv_nsec = ( timeout % TS_TIME_SEC_TO_USEC ) * TS_TIME_USEC_TO_NSEC;
+
+	struct io_uring_getevents_arg argument;
+	memset( &argument, 0x00, sizeof( argument ));
+	argument.ts = (uint64_t) (uintptr_t) &deadline;
+
+	return (int) syscall( __NR_io_uring_enter, uring->_fd, submit, complete,
+		IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &argument, sizeof( argument ));
+}
+
+static struct io_uring_sqe * _ts_uring_sqe( TsDriverUringRef_t uring ) {
+
+	unsigned tail = *( uring->_sq_tail ) + uring->_sq_pending;
+	if( tail - __atomic_load_n( uring->_sq_head, __ATOMIC_ACQUIRE ) >= uring->_sq_entries ) {
+		return NULL;
+	}
+	unsigned index = tail & *( uring->_sq_mask );
+	struct io_uring_sqe * sqe = &( uring->_sqes[ index ] );
+	memset( sqe, 0x00, sizeof( struct io_uring_sqe ));
+	uring->_sq_array[ index ] = index;
+	uring->_sq_pending = uring->_sq_pending + 1;
+	return sqe;
+}
+
+/**
+ * Submit the prepared requests and (when complete is non-zero) wait for up to timeout
+ * microseconds for a completion. The system call is counted as a read or a write.
+ */
+static void _ts_uring_submit( TsDriverSocketRef_t sock, unsigned complete, uint32_t timeout, bool write ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	unsigned submit = uring->_sq_pending;
+	if( submit > 0 ) {
+		__atomic_store_n( uring->_sq_tail, *( uring->_sq_tail ) + submit, __ATOMIC_RELEASE );
+		uring->_sq_pending = 0;
+	}
+	if( submit == 0 && complete == 0 ) {
+		// completions that did not fit are only flushed by waiting for events
+		if( !( __atomic_load_n( uring->_sq_flags, __ATOMIC_ACQUIRE ) & IORING_SQ_CQ_OVERFLOW )) {
+			return;
+		}
+	}
+	if( write ) {
+		_ts_stats_count( sock, _write_syscalls, 1 );
+	} else {
+		_ts_stats_count( sock, _read_syscalls, 1 );
+	}
+	if( _ts_uring_enter( uring, submit, complete, timeout ) < 0 && errno != ETIME && errno != EINTR ) {
+		ts_status_debug( "ts_driver_uring: ignoring enter error, %d\n", errno );
+	}
+}
+
+static void _ts_uring_recycle( TsDriverUringRef_t uring, uint16_t buffer ) {
 
-	// update write buffer size and return
-	*buffer_size = (size_t) index;
+	struct io_uring_buf * entry = &( uring->_buf_ring->bufs[ uring->_buf_tail & ( TS_DRIVER_URING_BUFFERS - 1 ) ] );
+	entry->addr = (uint64_t) (uintptr_t) ( uring->_buffers + (size_t) buffer * TS_DRIVER_URING_BUFFER_SIZE );
+	entry->len = TS_DRIVER_URING_BUFFER_SIZE;
+	entry->bid = buffer;
+	uring->_buf_tail = uring->_buf_tail + 1;
+	__atomic_store_n( &( uring->_buf_ring->tail ), uring->_buf_tail, __ATOMIC_RELEASE );
+}
+
+/**
+ * Hand a consumed buffer back to the kernel. A receive that ran out of buffers stays armed but
+ * only retries on new data, so when it was starved cancel it, the poll re-arms it afterwards.
+ */
+static void _ts_uring_release( TsDriverSocketRef_t sock ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	_ts_uring_recycle( uring, uring->_ready[ uring->_ready_head ] );
+	uring->_ready_head = ( uring->_ready_head + 1 ) % TS_DRIVER_URING_BUFFERS;
+	uring->_ready_count = uring->_ready_count - 1;
+	uring->_ready_offset = 0;
+
+	if( uring->_starved && uring->_receiving ) {
+		struct io_uring_sqe * sqe = _ts_uring_sqe( uring );
+		if( sqe != NULL ) {
+			sqe->opcode = IORING_OP_ASYNC_CANCEL;
+			sqe->addr = TS_DRIVER_URING_RX;
+			sqe->user_data = TS_DRIVER_URING_CANCEL;
+			uring->_starved = false;
+		}
+	}
+}
+
+static void _ts_uring_receive( TsDriverSocketRef_t sock ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	struct io_uring_sqe * sqe = _ts_uring_sqe( uring );
+	if( sqe == NULL ) {
+		return;
+	}
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = sock->_fd;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = TS_DRIVER_URING_GROUP;
+	sqe->user_data = TS_DRIVER_URING_RX;
+	uring->_receiving = true;
+}
+
+static void _ts_uring_write( TsDriverSocketRef_t sock ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	struct io_uring_sqe * sqe = _ts_uring_sqe( uring );
+	if( sqe == NULL ) {
+		uring->_tx_status = TsStatusErrorInternalServerError;
+		uring->_writing = false;
+		return;
+	}
+	sqe->opcode = IORING_OP_SEND;
+	sqe->fd = sock->_fd;
+	sqe->addr = (uint64_t) (uintptr_t) ( uring->_write_buffer + uring->_write_offset );
+	sqe->len = (uint32_t) ( uring->_write_size - uring->_write_offset );
+	sqe->msg_flags = MSG_NOSIGNAL;
+	sqe->user_data = TS_DRIVER_URING_TX;
+	uring->_writing = true;
+}
+
+static TsStatus_t _ts_uring_error( int error ) {
+
+	if( error == EPIPE || error == ECONNRESET ) {
+		return TsStatusErrorConnectionReset;
+	}
+	ts_status_debug( "ts_driver_uring: ignoring error, %d\n", error );
+	return TsStatusErrorInternalServerError;
+}
+
+/**
+ * Collect the completions, then re-arm the receive if it stopped and submit what was
+ * prepared. Makes no system call when there is nothing to submit.
+ */
+static void _ts_uring_poll( TsDriverSocketRef_t sock, bool write ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	unsigned head = *( uring->_cq_head );
+	unsigned tail = __atomic_load_n( uring->_cq_tail, __ATOMIC_ACQUIRE );
+	for( ; head != tail; head++ ) {
+
+		struct io_uring_cqe * cqe = &( uring->_cqes[ head & *( uring->_cq_mask ) ] );
+		if( cqe->user_data == TS_DRIVER_URING_RX ) {
+
+			if( cqe->res > 0 && ( cqe->flags & IORING_CQE_F_BUFFER )) {
+				size_t index = ( uring->_ready_head + uring->_ready_count ) % TS_DRIVER_URING_BUFFERS;
+				uring->_ready[ index ] = (uint16_t) ( cqe->flags >> IORING_CQE_BUFFER_SHIFT );
+				uring->_ready_size[ index ] = (uint32_t) cqe->res;
+				uring->_ready_count = uring->_ready_count + 1;
+			} else if( cqe->res == 0 ) {
+				uring->_rx_status = TsStatusErrorConnectionReset;
+			} else if( cqe->res != -ENOBUFS && cqe->res != -ECANCELED ) {
+				// out of buffers is not an error, the receive is re-armed once one is released
+				uring->_rx_status = _ts_uring_error( -cqe->res );
+			}
+			if( !( cqe->flags & IORING_CQE_F_MORE )) {
+				uring->_receiving = false;
+			}
+
+		} else if( cqe->user_data == TS_DRIVER_URING_TX ) {
+
+			uring->_writing = false;
+			if( cqe->res == -ECANCELED || cqe->res == -EAGAIN ) {
+				// nothing sent, see _ts_uring_send
+			} else if( cqe->res < 0 ) {
+				uring->_tx_status = _ts_uring_error( -cqe->res );
+			} else {
+				uring->_write_offset = uring->_write_offset + (size_t) cqe->res;
+				if( cqe->res > 0 && uring->_write_offset < uring->_write_size && !uring->_write_cancel ) {
+					_ts_uring_write( sock );
+				}
+			}
+
+		} else if( cqe->user_data == TS_DRIVER_URING_SIGNAL ) {
+
+			uring->_signalled = false;
+
+		} else if( cqe->user_data == TS_DRIVER_URING_WRITABLE ) {
+
+			uring->_polling = false;
+		}
+	}
+	__atomic_store_n( uring->_cq_head, head, __ATOMIC_RELEASE );
+
+	if( uring->_ready_count == TS_DRIVER_URING_BUFFERS ) {
+		uring->_starved = true;
+	}
+	if( !uring->_receiving && sock->_fd >= 0 && uring->_rx_status == TsStatusOk &&
+		uring->_ready_count < TS_DRIVER_URING_BUFFERS ) {
+		_ts_uring_receive( sock );
+	}
+	_ts_uring_submit( sock, 0, 0, write );
+}
+
+/**
+ * The ring's descriptor (see ts_driver_unix_fd) is readable while completions are queued. When
+ * received data (or the end of the connection) is left unread and none are, queue a no-op so
+ * that a wait on the descriptor returns all the same, as it would for a readable socket.
+ */
+static void _ts_uring_signal( TsDriverSocketRef_t sock ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	if( sock->_fd < 0 || uring->_signalled || ( uring->_ready_count == 0 && uring->_rx_status == TsStatusOk )) {
+		return;
+	}
+	if( *( uring->_cq_head ) != __atomic_load_n( uring->_cq_tail, __ATOMIC_ACQUIRE )) {
+		return;
+	}
+	struct io_uring_sqe * sqe = _ts_uring_sqe( uring );
+	if( sqe == NULL ) {
+		return;
+	}
+	sqe->opcode = IORING_OP_NOP;
+	sqe->user_data = TS_DRIVER_URING_SIGNAL;
+	uring->_signalled = true;
+	_ts_uring_submit( sock, 0, 0, false );
+}
+
+/**
+ * Copy up to size bytes out of the received buffers, handing each back once it is consumed.
+ */
+static size_t _ts_uring_copy( TsDriverSocketRef_t sock, uint8_t * buffer, size_t size ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	size_t index = 0;
+	while( index < size && uring->_ready_count > 0 ) {
+		uint16_t id = uring->_ready[ uring->_ready_head ];
+		size_t available = uring->_ready_size[ uring->_ready_head ] - uring->_ready_offset;
+		size_t length = ( size - index < available ) ? size - index : available;
+		memcpy( buffer + index, uring->_buffers + (size_t) id * TS_DRIVER_URING_BUFFER_SIZE + uring->_ready_offset, length );
+		index = index + length;
+		uring->_ready_offset = uring->_ready_offset + length;
+		if( uring->_ready_offset == uring->_ready_size[ uring->_ready_head ] ) {
+			_ts_uring_release( sock );
+		}
+	}
+	if( !uring->_receiving || uring->_sq_pending > 0 ) {
+		_ts_uring_poll( sock, false );
+	}
+	return index;
+}
+
+/**
+ * Take up to size received bytes, with the results of recv on a non-blocking socket.
+ */
+static ssize_t _ts_uring_recv( TsDriverSocketRef_t sock, uint8_t * buffer, size_t size ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	_ts_uring_poll( sock, false );
+	size_t index = _ts_uring_copy( sock, buffer, size );
+	_ts_uring_signal( sock );
+	if( index > 0 ) {
+		return (ssize_t) index;
+	}
+	if( uring->_rx_status == TsStatusOk ) {
+		errno = EAGAIN;
+		return -1;
+	}
+	if( uring->_rx_status == TsStatusErrorConnectionReset ) {
+		return 0;
+	}
+	errno = EIO;
+	return -1;
+}
+
+/**
+ * Wait for received data (or the end of the connection) within what is left of the budget.
+ */
+static bool _ts_uring_wait( TsDriverSocketRef_t sock, uint64_t timestamp, uint32_t budget ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	_ts_uring_poll( sock, false );
+	while( uring->_ready_count == 0 && uring->_rx_status == TsStatusOk ) {
+		uint64_t elapsed = ts_platform_time() - timestamp;
+		if( elapsed >= budget ) {
+			return false;
+		}
+		_ts_uring_submit( sock, 1, (uint32_t) ( budget - elapsed ), false );
+		_ts_uring_poll( sock, false );
+	}
+	return true;
+}
+
+/**
+ * Submit what was prepared and wait for the write in flight within what is left of the budget.
+ * A write just prepared is submitted and waited for with a single system call.
+ */
+static void _ts_uring_complete( TsDriverSocketRef_t sock, uint64_t timestamp, uint32_t budget ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	if( !uring->_writing || ts_platform_time() - timestamp >= budget ) {
+		_ts_uring_poll( sock, true );
+	}
+	while( uring->_writing ) {
+		uint64_t elapsed = ts_platform_time() - timestamp;
+		if( elapsed >= budget ) {
+			break;
+		}
+		_ts_uring_submit( sock, 1, (uint32_t) ( budget - elapsed ), true );
+		_ts_uring_poll( sock, true );
+	}
+}
+
+/**
+ * Send the given vector, from the given offset, a write buffer at a time. Each send is
+ * waited for within the budget; one still waiting for room when the budget is used up is
+ * cancelled, and a poll for the socket's writability is armed instead (its completion makes
+ * the ring's descriptor readable). So the sent size is exact when this returns, and nothing
+ * is left in flight to be overtaken by the next write. A cancel that does not complete within
+ * TS_DRIVER_URING_DRAIN shuts the connection down and returns TsStatusErrorInternalServerError.
+ */
+static TsStatus_t _ts_uring_send( TsDriverSocketRef_t sock, const struct iovec * vector, int count, size_t offset, size_t * sent, uint64_t timestamp, uint32_t budget ) {
+
+	TsDriverUringRef_t uring = sock->_uring;
+	*sent = 0;
+
+	// a send that outlived its cancel still owns the write buffer
+	_ts_uring_complete( sock, timestamp, budget );
+	if( uring->_writing ) {
+		return TsStatusOkWritePending;
+	}
+
+	size_t total = 0;
+	for( int i = 0; i < count; i++ ) {
+		total = total + vector[ i ].iov_len;
+	}
+	total = total - offset;
+
+	TsStatus_t status = TsStatusOk;
+	while( *sent < total ) {
+
+		// gather the next part into the write buffer
+		struct iovec local[ TS_DRIVER_UNIX_IOV_MAX ];
+		int local_count = _ts_iov_advance( vector, count, offset + *sent, local );
+		size_t size = 0;
+		for( int i = 0; i < local_count && size < TS_DRIVER_URING_WRITE_SIZE; i++ ) {
+			size_t length = TS_DRIVER_URING_WRITE_SIZE - size;
+			length = ( local[ i ].iov_len < length ) ? local[ i ].iov_len : length;
+			memcpy( uring->_write_buffer + size, local[ i ].iov_base, length );
+			size = size + length;
+		}
+		uring->_write_offset = 0;
+		uring->_write_size = size;
+		uring->_write_cancel = false;
+		uring->_tx_status = TsStatusOk;
+		_ts_uring_write( sock );
+		_ts_uring_complete( sock, timestamp, budget );
+
+		if( uring->_writing ) {
+			struct io_uring_sqe * sqe = _ts_uring_sqe( uring );
+			if( sqe != NULL ) {
+				sqe->opcode = IORING_OP_ASYNC_CANCEL;
+				sqe->addr = TS_DRIVER_URING_TX;
+				sqe->user_data = TS_DRIVER_URING_CANCEL;
+			}
+			uring->_write_cancel = true;
+			uint64_t cancelled = ts_platform_time();
+			while( uring->_writing && ts_platform_time() - cancelled < TS_DRIVER_URING_DRAIN ) {
+				_ts_uring_submit( sock, 1, TS_DRIVER_URING_DRAIN, true );
+				_ts_uring_poll( sock, true );
+			}
+			if( uring->_writing ) {
+				// what the send still pushes would never be reported, and the caller would
+				// write those bytes again, so end the stream instead of returning a wrong size
+				ts_status_alarm( "ts_driver_write: cancel did not complete, closing the connection\n" );
+				shutdown( sock->_fd, SHUT_RDWR );
+				uring->_tx_status = TsStatusErrorInternalServerError;
+			}
+		}
+
+		*sent = *sent + uring->_write_offset;
+		if( uring->_tx_status != TsStatusOk ) {
+			status = uring->_tx_status;
+			uring->_tx_status = TsStatusOk;
+			break;
+		}
+		if( uring->_write_offset < size || uring->_writing ) {
+			// the budget is used up
+			break;
+		}
+	}
+
+	if( status == TsStatusOk && *sent == 0 ) {
+		status = TsStatusOkWritePending;
+		if( !uring->_polling && sock->_fd >= 0 ) {
+			struct io_uring_sqe * sqe = _ts_uring_sqe( uring );
+			if( sqe != NULL ) {
+				sqe->opcode = IORING_OP_POLL_ADD;
+				sqe->fd = sock->_fd;
+				sqe->poll32_events = POLLOUT;
+				sqe->user_data = TS_DRIVER_URING_WRITABLE;
+				uring->_polling = true;
+				_ts_uring_submit( sock, 0, 0, true );
+			}
+		}
+	}
+	_ts_uring_signal( sock );
+	return status;
+}
+
+static int _ts_uring_fd( TsDriverSocketRef_t sock ) {
+	return sock->_uring->_fd;
+}
+
+static void _ts_uring_destroy( TsDriverUringRef_t uring ) {
+
+	if( uring->_fd >= 0 ) {
+		close( uring->_fd );
+	}
+	if( uring->_ring != NULL && uring->_ring != MAP_FAILED ) {
+		munmap( uring->_ring, uring->_ring_size );
+	}
+	if( uring->_sqes != NULL && (void *) uring->_sqes != MAP_FAILED ) {
+		munmap( uring->_sqes, uring->_sqes_size );
+	}
+	if( uring->_buf_ring != NULL && (void *) uring->_buf_ring != MAP_FAILED ) {
+		munmap( uring->_buf_ring, uring->_buf_ring_size );
+	}
+	if( uring->_buffers != NULL ) {
+		ts_platform_free( uring->_buffers, TS_DRIVER_URING_BUFFERS * TS_DRIVER_URING_BUFFER_SIZE );
+	}
+	if( uring->_write_buffer != NULL ) {
+		ts_platform_free( uring->_write_buffer, TS_DRIVER_URING_WRITE_SIZE );
+	}
+	ts_platform_free( uring, sizeof( TsDriverUring_t ));
+}
+
+static TsDriverUringRef_t _ts_uring_create() {
+
+	TsDriverUringRef_t uring = (TsDriverUringRef_t) ts_platform_malloc( sizeof( TsDriverUring_t ));
+	if( uring == NULL ) {
+		return NULL;
+	}
+	memset( uring, 0x00, sizeof( TsDriverUring_t ));
+	uring->_rx_status = TsStatusOk;
+	uring->_tx_status = TsStatusOk;
+
+	struct io_uring_params params;
+	memset( &params, 0x00, sizeof( params ));
+	params.flags = IORING_SETUP_CQSIZE;
+	params.cq_entries = TS_DRIVER_URING_COMPLETIONS;
+	uring->_fd = (int) syscall( __NR_io_uring_setup, TS_DRIVER_URING_ENTRIES, &params );
+	if( uring->_fd < 0 || !( params.features & IORING_FEAT_SINGLE_MMAP ) || !( params.features & IORING_FEAT_EXT_ARG )) {
+		ts_status_debug( "ts_driver_uring: io_uring not available, %d\n", errno );
+		_ts_uring_destroy( uring );
+		return NULL;
+	}
+
+	// map the rings, the submission and completion queues share one mapping
+	size_t sq_size = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+	size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof( struct io_uring_cqe );
+	uring->_ring_size = sq_size > cq_size ? sq_size : cq_size;
+	uring->_ring = mmap( NULL, uring->_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->_fd, IORING_OFF_SQ_RING );
+	uring->_sqes_size = params.sq_entries * sizeof( struct io_uring_sqe );
+	uring->_sqes = (struct io_uring_sqe *) mmap( NULL, uring->_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, uring->_fd, IORING_OFF_SQES );
+	if( uring->_ring == MAP_FAILED || (void *) uring->_sqes == MAP_FAILED ) {
+		_ts_uring_destroy( uring );
+		return NULL;
+	}
+	uint8_t * ring = (uint8_t *) uring->_ring;
+	uring->_sq_head = (unsigned *) ( ring + params.sq_off.head );
+	uring->_sq_tail = (unsigned *) ( ring + params.sq_off.tail );
+	uring->_sq_mask = (unsigned *) ( ring + params.sq_off.ring_mask );
+	uring->_sq_array = (unsigned *) ( ring + params.sq_off.array );
+	uring->_sq_flags = (unsigned *) ( ring + params.sq_off.flags );
+	uring->_sq_entries = params.sq_entries;
+	uring->_cq_head = (unsigned *) ( ring + params.cq_off.head );
+	uring->_cq_tail = (unsigned *) ( ring + params.cq_off.tail );
+	uring->_cq_mask = (unsigned *) ( ring + params.cq_off.ring_mask );
+	uring->_cqes = (struct io_uring_cqe *) ( ring + params.cq_off.cqes );
+
+	// provide the receive buffers, the buffer ring must be page aligned
+	uring->_buf_ring_size = TS_DRIVER_URING_BUFFERS * sizeof( struct io_uring_buf );
+	uring->_buf_ring = (struct io_uring_buf_ring *) mmap( NULL, uring->_buf_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+	uring->_buffers = (uint8_t *) ts_platform_malloc( TS_DRIVER_URING_BUFFERS * TS_DRIVER_URING_BUFFER_SIZE );
+	if( (void *) uring->_buf_ring == MAP_FAILED || uring->_buffers == NULL ) {
+		_ts_uring_destroy( uring );
+		return NULL;
+	}
+	struct io_uring_buf_reg registration;
+	memset( &registration, 0x00, sizeof( registration ));
+	registration.ring_addr = (uint64_t) (uintptr_t) uring->_buf_ring;
+	registration.ring_entries = TS_DRIVER_URING_BUFFERS;
+	registration.bgid = TS_DRIVER_URING_GROUP;
+	if( syscall( __NR_io_uring_register, uring->_fd, IORING_REGISTER_PBUF_RING, &registration, 1 ) < 0 ) {
+		ts_status_debug( "ts_driver_uring: provided buffer rings not available, %d\n", errno );
+		_ts_uring_destroy( uring );
+		return NULL;
+	}
+	for( uint16_t buffer = 0; buffer < TS_DRIVER_URING_BUFFERS; buffer++ ) {
+		_ts_uring_recycle( uring, buffer );
+	}
+
+	uring->_write_buffer = (uint8_t *) ts_platform_malloc( TS_DRIVER_URING_WRITE_SIZE );
+	if( uring->_write_buffer == NULL ) {
+		_ts_uring_destroy( uring );
+		return NULL;
+	}
+
+	return uring;
+}
+
+/**
+ * Datagrams (see _ts_datagram_receive), local connections (passed descriptors, see
+ * _ts_recv) and reconnecting drivers (see _ts_reconnect_tick) use the socket calls.
+ */
+static bool _ts_uring_used( TsDriverSocketRef_t sock ) {
+	return sock->_uring != NULL && !sock->_datagram && !sock->_local && !sock->_reconnect;
+}
+
+static TsStatus_t ts_create_uring( TsDriverRef_t * driver ) {
+
+	TsStatus_t status = ts_create( driver );
+	if( status != TsStatusOk ) {
+		return status;
+	}
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( *driver );
+	sock->_uring = _ts_uring_create();
+	if( sock->_uring == NULL ) {
+		ts_status_info( "ts_driver_create: io_uring not supported, using socket calls\n" );
+	}
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_destroy_uring( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( sock->_uring != NULL ) {
+		if( sock->_fd >= 0 ) {
+			ts_disconnect_uring( driver );
+		}
+		_ts_uring_destroy( sock->_uring );
+		sock->_uring = NULL;
+	}
+	return ts_destroy( driver );
+}
+
+static TsStatus_t ts_connect_uring( TsDriverRef_t driver, TsAddress_t address ) {
+
+	TsStatus_t status = ts_connect( driver, address );
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( status != TsStatusOk || !_ts_uring_used( sock )) {
+		return status;
+	}
+
+	// arm the receive, an immediate failure means multishot receive is not supported
+	TsDriverUringRef_t uring = sock->_uring;
+	uring->_rx_status = TsStatusOk;
+	uring->_tx_status = TsStatusOk;
+	_ts_uring_receive( sock );
+	_ts_uring_submit( sock, 0, 0, false );
+	_ts_uring_poll( sock, false );
+	if( uring->_rx_status != TsStatusOk ) {
+		ts_status_info( "ts_driver_connect: multishot receive not supported, using socket calls\n" );
+		_ts_uring_destroy( uring );
+		sock->_uring = NULL;
+	}
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_disconnect_uring( TsDriverRef_t driver ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	TsDriverUringRef_t uring = sock->_uring;
+	if( uring != NULL && sock->_fd >= 0 ) {
+
+		// end the requests in flight before the socket (and its buffers) go away
+		shutdown( sock->_fd, SHUT_RDWR );
+		uint64_t timestamp = ts_platform_time();
+		int fd = sock->_fd;
+		sock->_fd = -1;
+		while(( uring->_receiving || uring->_writing || uring->_polling ) && ts_platform_time() - timestamp < TS_DRIVER_URING_DRAIN ) {
+			_ts_uring_submit( sock, 1, TS_DRIVER_URING_DRAIN, false );
+			_ts_uring_poll( sock, false );
+		}
+		sock->_fd = fd;
+
+		// hand the unread buffers back
+		while( uring->_ready_count > 0 ) {
+			_ts_uring_recycle( uring, uring->_ready[ uring->_ready_head ] );
+			uring->_ready_head = ( uring->_ready_head + 1 ) % TS_DRIVER_URING_BUFFERS;
+			uring->_ready_count = uring->_ready_count - 1;
+		}
+		uring->_ready_offset = 0;
+		uring->_writing = false;
+		uring->_receiving = false;
+		uring->_starved = false;
+		uring->_polling = false;
+	}
+	return ts_disconnect( driver );
+}
+
+static TsStatus_t ts_read_uring( TsDriverRef_t driver, const uint8_t * buffer, size_t * buffer_size, uint32_t budget ) {
+
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( buffer != NULL );
+	ts_platform_assert( buffer_size != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	TsDriverUringRef_t uring = sock->_uring;
+	if( !_ts_uring_used( sock )) {
+		return ts_read( driver, buffer, buffer_size, budget );
+	}
+
+	uint64_t timestamp = ts_platform_time();
+	_ts_uring_poll( sock, false );
+	if( uring->_ready_count == 0 && sock->_read_wait ) {
+		_ts_uring_wait( sock, timestamp, budget );
+	}
+	size_t index = _ts_uring_copy( sock, (uint8_t *) buffer, *buffer_size );
+	_ts_uring_signal( sock );
+
+	TsStatus_t status = TsStatusOk;
+	if( index == 0 ) {
+		status = ( uring->_rx_status != TsStatusOk ) ? uring->_rx_status : TsStatusOkReadPending;
+	}
+	*buffer_size = index;
+	_ts_stats_read( sock, timestamp, index, status );
+	return status;
+}
+
+/**
+ * With a reader registered, the received buffers are handed to it in place.
+ */
+static TsStatus_t ts_tick_uring( TsDriverRef_t driver, uint32_t budget ) {
+
+	ts_platform_assert( driver != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	TsDriverUringRef_t uring = sock->_uring;
+	if( !_ts_uring_used( sock )) {
+		return ts_tick( driver, budget );
+	}
+	if( sock->_fd < 0 ) {
+		return TsStatusOk;
+	}
+
+	uint64_t timestamp = ts_platform_time();
+	_ts_uring_poll( sock, false );
+	if( sock->_driver._reader == NULL ) {
+		_ts_uring_signal( sock );
+		return TsStatusOk;
+	}
+	while( uring->_ready_count > 0 ) {
+		uint16_t id = uring->_ready[ uring->_ready_head ];
+		uint32_t connection = sock->_connection;
+		_ts_stats_count( sock, _bytes_in, uring->_ready_size[ uring->_ready_head ] - uring->_ready_offset );
+		bool reading = _ts_reader_deliver( sock,
+			uring->_buffers + (size_t) id * TS_DRIVER_URING_BUFFER_SIZE + uring->_ready_offset,
+			uring->_ready_size[ uring->_ready_head ] - uring->_ready_offset );
+		if( sock->_connection != connection ) {
+			// the reader disconnected, which handed the buffers back
+			return TsStatusOk;
+		}
+		_ts_uring_release( sock );
+		if( !reading ) {
+			break;
+		}
+		if( ts_platform_time() - timestamp > budget ) {
+			ts_status_debug( "ts_driver_tick: timer budget exceeded\n" );
+			_ts_stats_count( sock, _budget_overruns, 1 );
+			break;
+		}
+	}
+	_ts_uring_poll( sock, false );
+	_ts_uring_signal( sock );
+
+	if( uring->_ready_count == 0 && uring->_rx_status != TsStatusOk ) {
+		ts_status_alarm( "ts_driver_tick: reader failed, %s\n", ts_status_string( uring->_rx_status ));
+		return uring->_rx_status;
+	}
+	return TsStatusOk;
+}
+
+/**
+ * Send the given data through the write buffer, waiting for the sends within the budget
+ * (see _ts_uring_send). As with ts_write, the returned size is what was sent.
+ */
+static TsStatus_t ts_write_uring( TsDriverRef_t driver, const uint8_t * buffer, size_t * buffer_size, uint32_t budget ) {
+
+	ts_platform_assert( driver != NULL );
+	ts_platform_assert( buffer != NULL );
+	ts_platform_assert( buffer_size != NULL );
+
+	TsDriverSocketRef_t sock = (TsDriverSocketRef_t) ( driver );
+	if( !_ts_uring_used( sock )) {
+		return ts_write( driver, buffer, buffer_size, budget );
+	}
+
+	uint64_t timestamp = ts_platform_time();
+	struct iovec local;
+	local.iov_base = (void *) buffer;
+	local.iov_len = *buffer_size;
+	size_t size = 0;
+	TsStatus_t status = _ts_uring_send( sock, &local, 1, 0, &size, timestamp, budget );
+
+	_ts_stats_write( sock, timestamp, size, *buffer_size, status );
+	*buffer_size = size;
 	return status;
 }
 
+#endif // TS_DRIVER_SOCKET_URING
+
 static TsStatus_t _ts_driver_initialize_id( TsDriverSocketRef_t sock ) {
 //
 //	if( status == TsStatusOk ) {
@@ -0,0 +1,370 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#ifndef TS_DRIVER_UNIX_H
+#define TS_DRIVER_UNIX_H
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "ts_driver.h"
+
+// addresses raced per connect, and the default delay between starting them (rfc 8305)
+#ifndef TS_DRIVER_UNIX_CONNECT_MAX
+#define TS_DRIVER_UNIX_CONNECT_MAX 8
+#endif
+#ifndef TS_DRIVER_UNIX_CONNECT_STAGGER
+#define TS_DRIVER_UNIX_CONNECT_STAGGER 250000
+#endif
+
+// receive ring capacity, see ts_driver_unix_peek
+#ifndef TS_DRIVER_UNIX_RING_SIZE
+#define TS_DRIVER_UNIX_RING_SIZE 65536
+#endif
+
+// datagrams sent or received per system call (sendmmsg, recvmmsg), see _datagram
+#ifndef TS_DRIVER_UNIX_DATAGRAM_BATCH
+#define TS_DRIVER_UNIX_DATAGRAM_BATCH 16
+#endif
+
+// addresses of this form connect to a local (unix domain) socket, e.g., "unix:/run/bridge.sock";
+// on linux "unix:@name" names a socket in the abstract namespace
+#define TS_DRIVER_UNIX_LOCAL "unix:"
+
+// received descriptors held for ts_driver_unix_receive_fd, more are closed
+#ifndef TS_DRIVER_UNIX_FD_MAX
+#define TS_DRIVER_UNIX_FD_MAX 4
+#endif
+
+// default cap on the reconnect backoff in microseconds, see _reconnect_initial
+#ifndef TS_DRIVER_UNIX_RECONNECT_MAX
+#define TS_DRIVER_UNIX_RECONNECT_MAX 300000000
+#endif
+
+/**
+ * Connection state of the socket driver, see ts_driver_unix_reconnect.
+ */
+typedef enum TsDriverUnixState {
+
+	TsDriverUnixStateIdle = 0,      // not connected (never connected, disconnected, or reconnecting is not enabled)
+	TsDriverUnixStateConnecting,    // a reconnect attempt is in progress
+	TsDriverUnixStateConnected,
+	TsDriverUnixStateBackoff,       // the connection was lost, waiting for the next attempt
+
+} TsDriverUnixState_t;
+
+/**
+ * Called when the connection state of the driver changes, see ts_driver_unix_reconnect.
+ */
+typedef void (*TsDriverUnixStateCallback_t)( TsDriverRef_t driver, void * state, TsDriverUnixState_t connection );
+
+/**
+ * Called when the zero-copy sends numbered first to last (inclusive) have completed,
+ * see ts_driver_unix_zerocopy.
+ */
+typedef void (*TsDriverUnixCompletion_t)( TsDriverRef_t driver, void * state, uint32_t first, uint32_t last );
+
+/**
+ * Unix driver options, see ts_driver_unix_profile. A zeroed profile selects the system defaults.
+ *
+ * With _datagram the socket driver connects a udp socket instead, e.g., for MQTT-SN or CoAP
+ * telemetry. Every write (or writev) is sent as one datagram, and every read returns (and the
+ * reader is called with) one datagram, truncated to the given buffer (or the mtu for a reader).
+ * Receives are batched, up to TS_DRIVER_UNIX_DATAGRAM_BATCH datagrams per system call; with
+ * _cork, writes of up to the mtu are queued and sent in batches when the queue is full or on
+ * ts_driver_unix_flush. Tcp only options are ignored, and a refused datagram (no one listening
+ * at the peer) is reported as TsStatusErrorConnectionReset. Takes effect on the next connect.
+ */
+typedef struct TsDriverUnixProfile {
+
+	bool _nodelay;  // disable nagle, small (control) writes are sent immediately
+	bool _cork;     // hold back partial segments until ts_driver_unix_flush (TCP_CORK or TCP_NOPUSH)
+	bool _connect_async;         // race non-blocking connects to the resolved addresses (happy eyeballs)
+	bool _datagram;              // connect with udp, see below
+	uint32_t _connect_stagger;   // microseconds between starting attempts, zero for the default
+
+	int _rcvbuf;                    // SO_RCVBUF bytes, set before connect
+	int _sndbuf;                    // SO_SNDBUF bytes
+	uint32_t _keepalive_idle;       // seconds idle before keepalive probes start, non-zero enables SO_KEEPALIVE
+	uint32_t _keepalive_interval;   // seconds between probes
+	uint32_t _keepalive_count;      // unanswered probes before the connection is dropped
+	uint32_t _user_timeout;         // milliseconds written data may stay unacknowledged (TCP_USER_TIMEOUT, linux)
+	uint32_t _busy_poll;            // microseconds to busy poll the device on a blocking receive (SO_BUSY_POLL, linux)
+	int _tos;                       // IP_TOS (or IPV6_TCLASS) value, e.g., a dscp code point shifted left by two
+	size_t _zerocopy_threshold;     // writes of at least this many bytes use MSG_ZEROCOPY (linux), zero disables
+
+	uint32_t _reconnect_initial;    // microseconds, the first backoff ceiling; non-zero enables reconnecting from tick
+	uint32_t _reconnect_max;        // microseconds, the backoff cap, zero for TS_DRIVER_UNIX_RECONNECT_MAX
+	size_t _reconnect_queue;        // bytes of writes held while reconnecting, zero rejects them as pending
+
+} TsDriverUnixProfile_t;
+
+/**
+ * Return the file descriptor of the given (connected) driver, or -1, e.g., to register
+ * the driver with ts_wait and only read or tick it when it is ready.
+ *
+ * With the io_uring backend (TS_DRIVER_SOCKET_URING) this is the ring's descriptor, the
+ * socket itself is drained by the ring and never becomes readable. The ring's descriptor
+ * is readable while there is something to read (or the connection ended), and also once a
+ * write that returned TsStatusOkWritePending can make progress; wait for TS_WAIT_READABLE
+ * only, it is always writable. Datagram, local and reconnecting drivers use the socket
+ * calls, and this is the socket.
+ *
+ * A reconnecting driver gets a new descriptor per connection, see ts_driver_unix_reconnect.
+ */
+int ts_driver_unix_fd( TsDriverRef_t driver );
+
+// elements of a vector written per system call, longer vectors take more calls
+#ifndef TS_DRIVER_UNIX_IOV_MAX
+#define TS_DRIVER_UNIX_IOV_MAX 16
+#endif
+
+/**
+ * Write the given vector of buffers (scatter-gather), e.g., a protocol header, topic and payload,
+ * without first copying them into one staging buffer. Budget and pending semantics are those of
+ * ts_driver_write; a partial write is resumed by calling again with the returned written size.
+ *
+ * @param driver
+ * [in] The connected driver.
+ *
+ * @param vector
+ * [in] The buffers to write, in order.
+ *
+ * @param count
+ * [in] The number of elements in the vector.
+ *
+ * @param written
+ * [in/out] The number of bytes of the vector already written, zero on the first call,
+ * updated with the bytes written by this call.
+ *
+ * @param budget
+ * [in] The write budget in microseconds.
+ *
+ * @return
+ * TsStatusOk                   - The vector was (at least partially) written, see written.
+ * TsStatusOkWritePending       - A blocking condition exists (and avoided), nothing was written.
+ * TsStatusErrorConnectionReset - The peer closed the connection (socket driver).
+ */
+TsStatus_t ts_driver_unix_writev( TsDriverRef_t driver, const struct iovec * vector, int count, size_t * written, uint32_t budget );
+
+/**
+ * Socket driver only. Select whether ts_driver_read waits (with poll) for data to arrive for up
+ * to its budget, instead of returning TsStatusOkReadPending as soon as the socket is empty.
+ * Waiting delivers the first byte as soon as it arrives and removes the caller's retry loop;
+ * the default is not to wait.
+ *
+ * @param driver
+ * [in] The socket driver.
+ *
+ * @param wait
+ * [in] True to wait for up to the read budget.
+ */
+TsStatus_t ts_driver_unix_read_wait( TsDriverRef_t driver, bool wait );
+
+/**
+ * Socket driver only. Set the options of the given driver, they are applied to the
+ * current connection (if any) and to every new socket before it connects.
+ *
+ * @param driver
+ * [in] The socket driver.
+ *
+ * @param profile
+ * [in] The options, copied.
+ */
+TsStatus_t ts_driver_unix_profile( TsDriverRef_t driver, const TsDriverUnixProfile_t * profile );
+
+/**
+ * Socket driver only. Return the options in effect on the current connection, as reported by
+ * the system, e.g., linux reports twice the requested buffer sizes to account for overhead.
+ * Options the platform does not support are returned as configured.
+ *
+ * @param driver
+ * [in] The connected socket driver.
+ *
+ * @param profile
+ * [out] The effective options.
+ *
+ * @return
+ * TsStatusOk            - The effective options were returned
+ * TsStatusErrorNotFound - The driver is not connected, the configured options were returned
+ */
+TsStatus_t ts_driver_unix_profile_effective( TsDriverRef_t driver, TsDriverUnixProfile_t * profile );
+
+/**
+ * Send what has been written so far. With a corked profile, writes are coalesced into full
+ * segments until flushed, e.g., once per batch of publishes; otherwise this does nothing
+ * for sockets. Queued datagrams are sent in batches, TsStatusOkWritePending means some are
+ * still queued because the socket would block. On serial, wait until the written bytes have
+ * been transmitted.
+ */
+TsStatus_t ts_driver_unix_flush( TsDriverRef_t driver );
+
+/**
+ * Socket driver only. Receive into the driver's ring and return a view of all unread bytes,
+ * contiguous even across the wrap of the ring, so a parser can work on the data in place;
+ * inbound data is copied once, from the kernel. Bytes stay in the ring until released.
+ * Budget and read wait semantics are those of ts_driver_read. Do not mix with ts_driver_read
+ * or a reader on the same driver. Stream connections only.
+ *
+ * @param driver
+ * [in] The connected socket driver.
+ *
+ * @param view
+ * [out] The first unread byte, valid until the next peek, release or disconnect.
+ *
+ * @param size
+ * [out] The number of unread bytes, at most TS_DRIVER_UNIX_RING_SIZE (rounded up to a page).
+ *
+ * @param budget
+ * [in] The read budget in microseconds.
+ *
+ * @return
+ * TsStatusOk                   - There are unread bytes
+ * TsStatusOkReadPending        - Nothing to read (size is zero)
+ * TsStatusErrorConnectionReset - The peer closed the connection and everything was released
+ */
+TsStatus_t ts_driver_unix_peek( TsDriverRef_t driver, const uint8_t ** view, size_t * size, uint32_t budget );
+
+/**
+ * Socket driver only. Release the given number of bytes from the front of the last view,
+ * e.g., once a complete message has been parsed. A full ring reads no more until released.
+ */
+TsStatus_t ts_driver_unix_release( TsDriverRef_t driver, size_t size );
+
+/**
+ * Socket driver only. Register the callback for zero-copy completions. Writes of at least the
+ * profile's _zerocopy_threshold bytes are sent with MSG_ZEROCOPY, the kernel then transmits from
+ * the caller's pages instead of copying them, so the buffer must not be changed or released until
+ * its sends have completed. Completions are collected by ts_driver_tick; on disconnect everything
+ * outstanding is reported complete. Smaller writes, and platforms without MSG_ZEROCOPY, copy as
+ * usual. Worth it for large transfers only (the kernel suggests 10KB and up).
+ *
+ * @param driver
+ * [in] The socket driver.
+ *
+ * @param callback
+ * [in] The completion callback, may be NULL.
+ *
+ * @param state
+ * [in] Passed to the callback.
+ */
+TsStatus_t ts_driver_unix_zerocopy( TsDriverRef_t driver, TsDriverUnixCompletion_t callback, void * state );
+
+/**
+ * Socket driver only. Return the sequence number the next zero-copy send will get. Read it after a
+ * write, the write's buffer may be reused once the completion of the returned value minus one has
+ * been reported (when it is unchanged from before the write, nothing was sent zero-copy).
+ */
+uint32_t ts_driver_unix_zerocopy_sequence( TsDriverRef_t driver );
+
+/**
+ * Socket driver only. Register the callback for connection state changes. With _reconnect_initial
+ * set in the profile (at connect), a lost connection, or a failed connect, is re-established by
+ * ts_driver_tick: attempts are spaced by a random delay of up to a ceiling that starts at
+ * _reconnect_initial and doubles per failed attempt (up to _reconnect_max), so that devices which
+ * lost their connections together do not reconnect in lockstep. Each attempt is a non-blocking
+ * connect to the next of the addresses resolved at connect, bounded by the driver budget, so a
+ * tick never waits for the resolver; a connect that cannot resolve the address does not reconnect.
+ * Reconnecting drivers use the socket calls, not the io_uring backend (TS_DRIVER_SOCKET_URING).
+ *
+ * The call that detects the loss returns TsStatusErrorConnectionReset (a read at end-of-file
+ * included), later reads return TsStatusOkReadPending until reconnected. Writes made meanwhile
+ * are held, up to _reconnect_queue bytes, and sent once connected; the callback is called with
+ * TsDriverUnixStateConnected first, so writes it makes, e.g., a protocol handshake, go ahead of
+ * the held ones. Datagrams are not held, nor are descriptors (ts_driver_unix_send_fd returns
+ * TsStatusOkWritePending). An explicit disconnect stops reconnecting and drops the held writes.
+ *
+ * Each connection has its own descriptor (ts_driver_unix_fd): register it with ts_wait when the
+ * callback reports TsDriverUnixStateConnected, and remove it when the callback reports another
+ * state, which it does while the old descriptor is still open.
+ *
+ * @param driver
+ * [in] The socket driver.
+ *
+ * @param callback
+ * [in] The state callback, may be NULL.
+ *
+ * @param state
+ * [in] Passed to the callback.
+ */
+TsStatus_t ts_driver_unix_reconnect( TsDriverRef_t driver, TsDriverUnixStateCallback_t callback, void * state );
+
+/**
+ * Socket driver only. Return the connection state of the given driver.
+ */
+TsDriverUnixState_t ts_driver_unix_state( TsDriverRef_t driver );
+
+/**
+ * Socket driver only. Pass a descriptor to the peer of a local (TS_DRIVER_UNIX_LOCAL) connection,
+ * attached to the given bytes (at least one), which are written as by ts_driver_write. A partial
+ * write carried the descriptor, write the rest with ts_driver_write.
+ *
+ * @param driver
+ * [in] The connected socket driver.
+ *
+ * @param fd
+ * [in] The descriptor, the peer receives a duplicate of it.
+ *
+ * @param buffer
+ * [in] The bytes to write with the descriptor.
+ *
+ * @param buffer_size
+ * [in] The number of bytes to write.
+ * [out] The number of bytes written.
+ *
+ * @return
+ * TsStatusOk                   - The descriptor and (at least part of) the bytes were written
+ * TsStatusOkWritePending       - A blocking condition exists (and avoided), nothing was written
+ * TsStatusErrorNotImplemented  - The driver is not connected to a local socket
+ * TsStatusErrorConnectionReset - The peer closed the connection
+ */
+TsStatus_t ts_driver_unix_send_fd( TsDriverRef_t driver, int fd, const uint8_t * buffer, size_t * buffer_size );
+
+/**
+ * Socket driver only. Return the oldest descriptor the peer of a local connection passed along
+ * with the data read so far (by read, the reader or peek), or -1 when there is none. With a
+ * _datagram profile the descriptors of a whole batch of datagrams are held once the first of
+ * them is read. The caller owns the returned descriptor; those not taken are closed on disconnect.
+ */
+int ts_driver_unix_receive_fd( TsDriverRef_t driver );
+
+#if defined(TS_DRIVER_STATS)
+
+// log2 buckets of call latency in microseconds, the last bucket counts everything slower
+#define TS_DRIVER_UNIX_STATS_BUCKETS 24
+
+typedef struct TsDriverUnixStats {
+	uint64_t _bytes_in;
+	uint64_t _bytes_out;
+	uint64_t _reads;             // read (and peek) calls
+	uint64_t _writes;            // write (and writev) calls
+	uint64_t _read_syscalls;     // including those made by tick for the reader
+	uint64_t _write_syscalls;
+	uint64_t _read_pending;      // reads that returned TsStatusOkReadPending
+	uint64_t _write_pending;     // writes that returned TsStatusOkWritePending
+	uint64_t _budget_overruns;   // calls that exceeded their budget
+	uint64_t _partial_writes;    // writes that returned with part of the data unwritten
+	uint64_t _connects;
+	uint64_t _reconnects;        // connects after the first
+	uint64_t _read_latency[ TS_DRIVER_UNIX_STATS_BUCKETS ];    // bucket i counts calls under 2^i usec
+	uint64_t _write_latency[ TS_DRIVER_UNIX_STATS_BUCKETS ];
+} TsDriverUnixStats_t;
+
+/**
+ * Copy the i/o statistics of the given driver, enabled with TS_DRIVER_STATS. The driver
+ * is not thread safe, read them from the thread that services the driver.
+ *
+ * @param driver
+ * [in] The driver.
+ *
+ * @param stats
+ * [out] The statistics, see TsDriverUnixStats_t.
+ */
+TsStatus_t ts_driver_unix_stats( TsDriverRef_t driver, TsDriverUnixStats_t * stats );
+
+/**
+ * Zero the i/o statistics of the given driver, e.g., at the start of a reporting period.
+ */
+TsStatus_t ts_driver_unix_stats_reset( TsDriverRef_t driver );
+
+#endif // TS_DRIVER_STATS
+
+#endif // TS_DRIVER_UNIX_H
@@ -1,10 +1,116 @@
 // Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
 #if defined(TS_MUTEX_CUSTOM)
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // for pthread_mutex_clocklock and the rwlock variants
+#endif
+#include <errno.h>
+#include <limits.h>
 #include <pthread.h>
+#include <time.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define TS_MUTEX_FUTEX
+#endif
 #include <memory.h>
+#include <stdbool.h>
 
 #include "ts_platform.h"
 #include "ts_mutex.h"
+#include "ts_mutex_unix.h"
+
+// number of trylock attempts made before parking a contended lock in the kernel,
+// zero parks immediately
+#ifndef TS_MUTEX_SPIN_COUNT
+#define TS_MUTEX_SPIN_COUNT 100
+#endif
+
+#if defined(__arm__) || defined(__aarch64__)
+#define ts_mutex_relax() __asm__ __volatile__( "yield" ::: "memory" )
+#elif defined(__i386__) || defined(__x86_64__)
+#define ts_mutex_relax() __asm__ __volatile__( "pause" ::: "memory" )
+#else
+#define ts_mutex_relax()
+#endif
+
+typedef struct TsMutexUnix * TsMutexUnixRef_t;
+typedef struct TsMutexUnix {
+
+	pthread_mutex_t _mutex;
+#if defined(TS_MUTEX_STATS)
+	uint64_t _acquired;
+	TsMutexStats_t _stats;
+#endif
+
+} TsMutexUnix_t;
+
+#if defined(TS_MUTEX_STATIC)
+
+// preallocated mutex table, enabled with TS_MUTEX_STATIC
+//
+// mutexes come from a fixed table instead of the heap, each entry padded to
+// its own cache line so neighbouring locks never share one. free entries are
+// kept on a lock-free stack; the head packs a generation tag next to the
+// index so a pop racing with a pop-push of the same entry fails its cas.
+
+#ifndef TS_MUTEX_STATIC_COUNT
+#define TS_MUTEX_STATIC_COUNT 64
+#endif
+#ifndef TS_MUTEX_CACHE_LINE
+#define TS_MUTEX_CACHE_LINE 64
+#endif
+
+typedef struct TsMutexUnixEntry {
+	TsMutexUnix_t _mutex;
+	uint32_t _next;   // index + 1 of the next free entry, zero ends the list
+} __attribute__(( aligned( TS_MUTEX_CACHE_LINE ))) TsMutexUnixEntry_t;
+
+static TsMutexUnixEntry_t _table[ TS_MUTEX_STATIC_COUNT ];
+static uint64_t _table_free;
+static pthread_once_t _table_once = PTHREAD_ONCE_INIT;
+
+static void _ts_table_initialize() {
+
+	for( uint32_t index = 0; index < TS_MUTEX_STATIC_COUNT; index++ ) {
+		_table[ index ]._next = ( index + 1 < TS_MUTEX_STATIC_COUNT ) ? index + 2 : 0;
+	}
+	__atomic_store_n( &_table_free, (uint64_t) 1, __ATOMIC_RELEASE );
+}
+
+static TsMutexUnixRef_t _ts_table_pop() {
+
+	pthread_once( &_table_once, _ts_table_initialize );
+
+	uint64_t head = __atomic_load_n( &_table_free, __ATOMIC_ACQUIRE );
+	uint64_t next;
+	do {
+		uint32_t index = (uint32_t) head;
+		if( index == 0 ) {
+			return NULL;
+		}
+		uint32_t following = __atomic_load_n( &( _table[ index - 1 ]._next ), __ATOMIC_RELAXED );
+		next = ((( head >> 32 ) + 1 ) << 32 ) | following;
+	} while( !__atomic_compare_exchange_n( &_table_free, &head, next, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ));
+
+	return &( _table[ (uint32_t) head - 1 ]._mutex );
+}
+
+static void _ts_table_push( TsMutexUnixRef_t unix_mutex ) {
+
+	TsMutexUnixEntry_t * entry = (TsMutexUnixEntry_t *) unix_mutex;
+	ts_platform_assert( entry >= _table && entry < _table + TS_MUTEX_STATIC_COUNT );
+	uint32_t index = (uint32_t) ( entry - _table );
+
+	uint64_t head = __atomic_load_n( &_table_free, __ATOMIC_ACQUIRE );
+	uint64_t next;
+	do {
+		__atomic_store_n( &( entry->_next ), (uint32_t) head, __ATOMIC_RELAXED );
+		next = ((( head >> 32 ) + 1 ) << 32 ) | ( index + 1 );
+	} while( !__atomic_compare_exchange_n( &_table_free, &head, next, true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ));
+}
+
+#endif // TS_MUTEX_STATIC
 
 static TsStatus_t ts_create(TsMutexRef_t *);
 static TsStatus_t ts_destroy(TsMutexRef_t);
@@ -21,40 +127,480 @@ const TsMutexVtable_t * ts_mutex = &(ts_mutex_unix);
 
 static TsStatus_t ts_create(TsMutexRef_t * mutex ) {
 
-	pthread_mutex_t * pthread_mutex;
-	pthread_mutex = (pthread_mutex_t*)(ts_platform_malloc(sizeof(pthread_mutex_t)));
-	memset( pthread_mutex, 0x00, sizeof(pthread_mutex_t));
+	TsMutexUnixRef_t unix_mutex;
+#if defined(TS_MUTEX_STATIC)
+	unix_mutex = _ts_table_pop();
+	if( unix_mutex == NULL ) {
+		ts_status_alarm( "ts_mutex_create: mutex table exhausted, increase TS_MUTEX_STATIC_COUNT\n" );
+		*mutex = NULL;
+		return TsStatusErrorInternalServerError;
+	}
+#else
+	unix_mutex = (TsMutexUnixRef_t)(ts_platform_malloc(sizeof(TsMutexUnix_t)));
+	if( unix_mutex == NULL ) {
+		*mutex = NULL;
+		return TsStatusErrorInternalServerError;
+	}
+#endif
+	memset( unix_mutex, 0x00, sizeof(TsMutexUnix_t));
 
-	if( pthread_mutex_init( pthread_mutex, NULL ) < 0 ) {
-		ts_platform_free(pthread_mutex, sizeof(pthread_mutex_t));
+	if( pthread_mutex_init( &(unix_mutex->_mutex), NULL ) != 0 ) {
+#if defined(TS_MUTEX_STATIC)
+		_ts_table_push( unix_mutex );
+#else
+		ts_platform_free(unix_mutex, sizeof(TsMutexUnix_t));
+#endif
 		*mutex = NULL;
 		return TsStatusErrorInternalServerError;
 	}
-	*mutex = (TsMutexRef_t)pthread_mutex;
+	*mutex = (TsMutexRef_t)unix_mutex;
 	return TsStatusOk;
 }
 
 static TsStatus_t ts_destroy(TsMutexRef_t mutex) {
 
-	pthread_mutex_t * pthread_mutex = (pthread_mutex_t*)mutex;
-	ts_platform_free( pthread_mutex, sizeof(pthread_mutex_t));
+	TsMutexUnixRef_t unix_mutex = (TsMutexUnixRef_t)mutex;
+	pthread_mutex_destroy( &(unix_mutex->_mutex) );
+#if defined(TS_MUTEX_STATIC)
+	_ts_table_push( unix_mutex );
+#else
+	ts_platform_free( unix_mutex, sizeof(TsMutexUnix_t));
+#endif
 
 	return TsStatusOk;
 }
 
+#if defined(TS_MUTEX_STATS)
+static void _ts_acquired( TsMutexUnixRef_t unix_mutex, bool contended, uint64_t timestamp ) {
+
+	// owned by this thread from here on, no atomics needed
+	unix_mutex->_acquired = ts_platform_time();
+	unix_mutex->_stats._acquisitions++;
+	if( contended ) {
+		uint64_t wait = unix_mutex->_acquired - timestamp;
+		unix_mutex->_stats._contended++;
+		unix_mutex->_stats._wait_usec += wait;
+		if( wait > unix_mutex->_stats._max_wait_usec ) {
+			unix_mutex->_stats._max_wait_usec = wait;
+		}
+	}
+}
+#endif
+
+/**
+ * Acquire the given mutex. An uncontended lock costs a single trylock, a contended
+ * lock spins for TS_MUTEX_SPIN_COUNT attempts before parking in the kernel, which
+ * avoids the context switch for the short critical sections typical of the sdk.
+ */
 static TsStatus_t ts_lock(TsMutexRef_t mutex) {
 
-	pthread_mutex_t * pthread_mutex = (pthread_mutex_t*)mutex;
-	pthread_mutex_lock( pthread_mutex );
+	TsMutexUnixRef_t unix_mutex = (TsMutexUnixRef_t)mutex;
+	int result = pthread_mutex_trylock( &(unix_mutex->_mutex) );
+#if defined(TS_MUTEX_STATS)
+	bool contended = ( result == EBUSY );
+	uint64_t timestamp = ts_platform_time();
+#endif
+	for( int spin = 0; result == EBUSY && spin < TS_MUTEX_SPIN_COUNT; spin++ ) {
+		ts_mutex_relax();
+		result = pthread_mutex_trylock( &(unix_mutex->_mutex) );
+	}
+	if( result == EBUSY ) {
+		result = pthread_mutex_lock( &(unix_mutex->_mutex) );
+	}
+	if( result != 0 ) {
+		ts_status_alarm( "ts_mutex_lock: failed, %d\n", result );
+		return TsStatusErrorInternalServerError;
+	}
 
+#if defined(TS_MUTEX_STATS)
+	_ts_acquired( unix_mutex, contended, timestamp );
+#endif
 	return TsStatusOk;
 }
 
 static TsStatus_t ts_unlock(TsMutexRef_t mutex) {
 
-	pthread_mutex_t * pthread_mutex = (pthread_mutex_t*)mutex;
-	pthread_mutex_unlock( pthread_mutex );
+	TsMutexUnixRef_t unix_mutex = (TsMutexUnixRef_t)mutex;
+
+#if defined(TS_MUTEX_STATS)
+	uint64_t hold = ts_platform_time() - unix_mutex->_acquired;
+	unix_mutex->_stats._hold_usec += hold;
+	if( hold > unix_mutex->_stats._max_hold_usec ) {
+		unix_mutex->_stats._max_hold_usec = hold;
+	}
+#endif
+
+	int result = pthread_mutex_unlock( &(unix_mutex->_mutex) );
+	if( result != 0 ) {
+		ts_status_alarm( "ts_mutex_unlock: failed, %d\n", result );
+		return TsStatusErrorInternalServerError;
+	}
+	return TsStatusOk;
+}
+
+#if defined(__linux__)
+// timed pthread locks take an absolute deadline; the clocklock variants (glibc 2.30)
+// measure it on the monotonic clock, so a step of the wall clock cannot stretch or
+// collapse the timeout
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 30 ))
+#define TS_MUTEX_CLOCK CLOCK_MONOTONIC
+#define ts_mutex_timedlock( lock, deadline ) pthread_mutex_clocklock( lock, TS_MUTEX_CLOCK, deadline )
+#define ts_mutex_timedrdlock( lock, deadline ) pthread_rwlock_clockrdlock( lock, TS_MUTEX_CLOCK, deadline )
+#define ts_mutex_timedwrlock( lock, deadline ) pthread_rwlock_clockwrlock( lock, TS_MUTEX_CLOCK, deadline )
+#else
+#define TS_MUTEX_CLOCK CLOCK_REALTIME
+#define ts_mutex_timedlock( lock, deadline ) pthread_mutex_timedlock( lock, deadline )
+#define ts_mutex_timedrdlock( lock, deadline ) pthread_rwlock_timedrdlock( lock, deadline )
+#define ts_mutex_timedwrlock( lock, deadline ) pthread_rwlock_timedwrlock( lock, deadline )
+#endif
+
+static void _ts_deadline( uint32_t timeout, struct timespec * deadline ) {
+
+	clock_gettime( TS_MUTEX_CLOCK, deadline );
+	deadline->tv_sec = deadline->tv_sec + timeout / TS_TIME_SEC_TO_USEC;
+	deadline->tv_nsec = deadline->tv_nsec + ( timeout % TS_TIME_SEC_TO_USEC ) * TS_TIME_USEC_TO_NSEC;
+	if( deadline->tv_nsec >= 1000000000L ) {
+		deadline->tv_sec = deadline->tv_sec + 1;
+		deadline->tv_nsec = deadline->tv_nsec - 1000000000L;
+	}
+}
+#else
+// no timed locks on this platform, retry until the timeout expires
+static int _ts_trylock_mutex( void * lock ) {
+	return pthread_mutex_trylock( (pthread_mutex_t *) lock );
+}
+
+static int _ts_trylock_read( void * lock ) {
+	return pthread_rwlock_tryrdlock( (pthread_rwlock_t *) lock );
+}
+
+static int _ts_trylock_write( void * lock ) {
+	return pthread_rwlock_trywrlock( (pthread_rwlock_t *) lock );
+}
+
+static int _ts_retry( int (*trylock)( void * ), void * lock, uint32_t timeout ) {
+
+	uint64_t timestamp = ts_platform_time();
+	int result = trylock( lock );
+	while( result == EBUSY && ts_platform_time() - timestamp < timeout ) {
+		ts_platform_sleep( 50 );
+		result = trylock( lock );
+	}
+	return result;
+}
+#endif
+
+TsStatus_t ts_mutex_unix_trylock( TsMutexRef_t mutex, uint32_t timeout ) {
+
+	ts_platform_assert( mutex != NULL );
+
+	TsMutexUnixRef_t unix_mutex = (TsMutexUnixRef_t)mutex;
+#if defined(TS_MUTEX_STATS)
+	uint64_t timestamp = ts_platform_time();
+#endif
+	int result = pthread_mutex_trylock( &(unix_mutex->_mutex) );
+#if defined(TS_MUTEX_STATS)
+	bool contended = ( result == EBUSY );
+#endif
+	if( result == EBUSY && timeout > 0 ) {
+#if defined(__linux__)
+		struct timespec deadline;
+		_ts_deadline( timeout, &deadline );
+		result = ts_mutex_timedlock( &(unix_mutex->_mutex), &deadline );
+#else
+		result = _ts_retry( _ts_trylock_mutex, &(unix_mutex->_mutex), timeout );
+#endif
+	}
+	if( result == EBUSY || result == ETIMEDOUT ) {
+		return TsStatusOkWritePending;
+	} else if( result != 0 ) {
+		ts_status_alarm( "ts_mutex_trylock: failed, %d\n", result );
+		return TsStatusErrorInternalServerError;
+	}
+#if defined(TS_MUTEX_STATS)
+	_ts_acquired( unix_mutex, contended, timestamp );
+#endif
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_rwlock_create( TsRwlockRef_t * rwlock ) {
+
+	ts_platform_assert( rwlock != NULL );
+
+	pthread_rwlock_t * pthread_rwlock;
+	pthread_rwlock = (pthread_rwlock_t*)(ts_platform_malloc(sizeof(pthread_rwlock_t)));
+	if( pthread_rwlock == NULL ) {
+		*rwlock = NULL;
+		return TsStatusErrorInternalServerError;
+	}
+
+	pthread_rwlockattr_t attributes;
+	pthread_rwlockattr_init( &attributes );
+#if defined(__GLIBC__)
+	// glibc prefers readers by default, which starves writers under read-mostly load
+	pthread_rwlockattr_setkind_np( &attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP );
+#endif
+	int result = pthread_rwlock_init( pthread_rwlock, &attributes );
+	pthread_rwlockattr_destroy( &attributes );
+	if( result != 0 ) {
+		ts_platform_free( pthread_rwlock, sizeof(pthread_rwlock_t));
+		*rwlock = NULL;
+		return TsStatusErrorInternalServerError;
+	}
+	*rwlock = (TsRwlockRef_t)pthread_rwlock;
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_rwlock_destroy( TsRwlockRef_t rwlock ) {
+
+	ts_platform_assert( rwlock != NULL );
+
+	pthread_rwlock_t * pthread_rwlock = (pthread_rwlock_t*)rwlock;
+	pthread_rwlock_destroy( pthread_rwlock );
+	ts_platform_free( pthread_rwlock, sizeof(pthread_rwlock_t));
+
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_read_lock( TsRwlockRef_t rwlock, uint32_t timeout ) {
+
+	ts_platform_assert( rwlock != NULL );
+
+	pthread_rwlock_t * pthread_rwlock = (pthread_rwlock_t*)rwlock;
+	int result;
+	if( timeout == TS_MUTEX_UNIX_FOREVER ) {
+		result = pthread_rwlock_rdlock( pthread_rwlock );
+	} else {
+		result = pthread_rwlock_tryrdlock( pthread_rwlock );
+		if( result == EBUSY && timeout > 0 ) {
+#if defined(__linux__)
+			struct timespec deadline;
+			_ts_deadline( timeout, &deadline );
+			result = ts_mutex_timedrdlock( pthread_rwlock, &deadline );
+#else
+			result = _ts_retry( _ts_trylock_read, pthread_rwlock, timeout );
+#endif
+		}
+	}
+	if( result == EBUSY || result == ETIMEDOUT ) {
+		return TsStatusOkReadPending;
+	} else if( result != 0 ) {
+		ts_status_alarm( "ts_mutex_read_lock: failed, %d\n", result );
+		return TsStatusErrorInternalServerError;
+	}
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_write_lock( TsRwlockRef_t rwlock, uint32_t timeout ) {
+
+	ts_platform_assert( rwlock != NULL );
+
+	pthread_rwlock_t * pthread_rwlock = (pthread_rwlock_t*)rwlock;
+	int result;
+	if( timeout == TS_MUTEX_UNIX_FOREVER ) {
+		result = pthread_rwlock_wrlock( pthread_rwlock );
+	} else {
+		result = pthread_rwlock_trywrlock( pthread_rwlock );
+		if( result == EBUSY && timeout > 0 ) {
+#if defined(__linux__)
+			struct timespec deadline;
+			_ts_deadline( timeout, &deadline );
+			result = ts_mutex_timedwrlock( pthread_rwlock, &deadline );
+#else
+			result = _ts_retry( _ts_trylock_write, pthread_rwlock, timeout );
+#endif
+		}
+	}
+	if( result == EBUSY || result == ETIMEDOUT ) {
+		return TsStatusOkWritePending;
+	} else if( result != 0 ) {
+		ts_status_alarm( "ts_mutex_write_lock: failed, %d\n", result );
+		return TsStatusErrorInternalServerError;
+	}
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_rwlock_unlock( TsRwlockRef_t rwlock ) {
+
+	ts_platform_assert( rwlock != NULL );
+
+	int result = pthread_rwlock_unlock( (pthread_rwlock_t*)rwlock );
+	if( result != 0 ) {
+		ts_status_alarm( "ts_mutex_rwlock_unlock: failed, %d\n", result );
+		return TsStatusErrorInternalServerError;
+	}
+	return TsStatusOk;
+}
+
+// events
+//
+// a manual reset flag; waiting on a set event and notifying an event nobody
+// waits on are both a single atomic operation. otherwise waiters block on the
+// flag itself with a futex on linux, or on a condition variable elsewhere,
+// with timeouts measured on the monotonic clock in both cases.
+
+typedef struct TsEventUnix * TsEventUnixRef_t;
+typedef struct TsEventUnix {
+
+	int _state;
+	int _waiters;
+#if !defined(TS_MUTEX_FUTEX)
+	pthread_mutex_t _mutex;
+	pthread_cond_t _condition;
+#endif
+
+} TsEventUnix_t;
+
+TsStatus_t ts_mutex_unix_event_create( TsEventRef_t * event ) {
+
+	ts_platform_assert( event != NULL );
+
+	TsEventUnixRef_t unix_event = (TsEventUnixRef_t)(ts_platform_malloc(sizeof(TsEventUnix_t)));
+	if( unix_event == NULL ) {
+		*event = NULL;
+		return TsStatusErrorInternalServerError;
+	}
+	memset( unix_event, 0x00, sizeof(TsEventUnix_t));
+
+#if !defined(TS_MUTEX_FUTEX)
+	pthread_condattr_t attributes;
+	pthread_condattr_init( &attributes );
+#if !defined(__APPLE__)
+	pthread_condattr_setclock( &attributes, CLOCK_MONOTONIC );
+#endif
+	if( pthread_mutex_init( &(unix_event->_mutex), NULL ) != 0 ||
+		pthread_cond_init( &(unix_event->_condition), &attributes ) != 0 ) {
+		pthread_condattr_destroy( &attributes );
+		ts_platform_free( unix_event, sizeof(TsEventUnix_t));
+		*event = NULL;
+		return TsStatusErrorInternalServerError;
+	}
+	pthread_condattr_destroy( &attributes );
+#endif
+
+	*event = (TsEventRef_t)unix_event;
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_event_destroy( TsEventRef_t event ) {
+
+	ts_platform_assert( event != NULL );
+
+	TsEventUnixRef_t unix_event = (TsEventUnixRef_t)event;
+#if !defined(TS_MUTEX_FUTEX)
+	pthread_cond_destroy( &(unix_event->_condition) );
+	pthread_mutex_destroy( &(unix_event->_mutex) );
+#endif
+	ts_platform_free( unix_event, sizeof(TsEventUnix_t));
+
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_event_wait( TsEventRef_t event, uint32_t timeout ) {
+
+	ts_platform_assert( event != NULL );
+
+	TsEventUnixRef_t unix_event = (TsEventUnixRef_t)event;
+	if( __atomic_load_n( &(unix_event->_state), __ATOMIC_ACQUIRE ) != 0 ) {
+		return TsStatusOk;
+	}
+	if( timeout == 0 ) {
+		return TsStatusOkReadPending;
+	}
+
+	// announce the waiter before the final check of the flag, notify
+	// sets the flag before it looks for waiters
+	__atomic_add_fetch( &(unix_event->_waiters), 1, __ATOMIC_SEQ_CST );
+#if defined(TS_MUTEX_FUTEX)
+	uint64_t timestamp = ts_platform_time();
+	while( __atomic_load_n( &(unix_event->_state), __ATOMIC_SEQ_CST ) == 0 ) {
+		struct timespec remaining;
+		struct timespec * relative = NULL;
+		if( timeout != TS_MUTEX_UNIX_FOREVER ) {
+			uint64_t elapsed = ts_platform_time() - timestamp;
+			if( elapsed >= timeout ) {
+				break;
+			}
+			remaining.tv_sec = ( timeout - elapsed ) / TS_TIME_SEC_TO_USEC;
+			remaining.tv_nsec = (( timeout - elapsed ) % TS_TIME_SEC_TO_USEC ) * TS_TIME_USEC_TO_NSEC;
+			relative = &remaining;
+		}
+		// returns immediately when the flag is no longer zero; relative
+		// futex timeouts are measured on the monotonic clock
+		syscall( SYS_futex, &(unix_event->_state), FUTEX_WAIT_PRIVATE, 0, relative, NULL, 0 );
+	}
+#else
+	struct timespec deadline;
+#if defined(__APPLE__)
+	clock_gettime( CLOCK_REALTIME, &deadline );
+#else
+	clock_gettime( CLOCK_MONOTONIC, &deadline );
+#endif
+	if( timeout != TS_MUTEX_UNIX_FOREVER ) {
+		deadline.tv_sec = deadline.tv_sec + timeout / TS_TIME_SEC_TO_USEC;
+		deadline.tv_nsec = deadline.tv_nsec + ( timeout % TS_TIME_SEC_TO_USEC ) * TS_TIME_USEC_TO_NSEC;
+		if( deadline.tv_nsec >= 1000000000L ) {
+			deadline.tv_sec = deadline.tv_sec + 1;
+			deadline.tv_nsec = deadline.tv_nsec - 1000000000L;
+		}
+	}
+	pthread_mutex_lock( &(unix_event->_mutex) );
+	while( __atomic_load_n( &(unix_event->_state), __ATOMIC_SEQ_CST ) == 0 ) {
+		if( timeout == TS_MUTEX_UNIX_FOREVER ) {
+			pthread_cond_wait( &(unix_event->_condition), &(unix_event->_mutex) );
+		} else if( pthread_cond_timedwait( &(unix_event->_condition), &(unix_event->_mutex), &deadline ) == ETIMEDOUT ) {
+			break;
+		}
+	}
+	pthread_mutex_unlock( &(unix_event->_mutex) );
+#endif
+	__atomic_sub_fetch( &(unix_event->_waiters), 1, __ATOMIC_SEQ_CST );
+
+	if( __atomic_load_n( &(unix_event->_state), __ATOMIC_ACQUIRE ) != 0 ) {
+		return TsStatusOk;
+	}
+	return TsStatusOkReadPending;
+}
+
+TsStatus_t ts_mutex_unix_event_notify( TsEventRef_t event ) {
+
+	ts_platform_assert( event != NULL );
+
+	TsEventUnixRef_t unix_event = (TsEventUnixRef_t)event;
+	if( __atomic_exchange_n( &(unix_event->_state), 1, __ATOMIC_SEQ_CST ) == 0 &&
+		__atomic_load_n( &(unix_event->_waiters), __ATOMIC_SEQ_CST ) > 0 ) {
+#if defined(TS_MUTEX_FUTEX)
+		syscall( SYS_futex, &(unix_event->_state), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0 );
+#else
+		pthread_mutex_lock( &(unix_event->_mutex) );
+		pthread_cond_broadcast( &(unix_event->_condition) );
+		pthread_mutex_unlock( &(unix_event->_mutex) );
+#endif
+	}
+	return TsStatusOk;
+}
+
+TsStatus_t ts_mutex_unix_event_reset( TsEventRef_t event ) {
+
+	ts_platform_assert( event != NULL );
+
+	TsEventUnixRef_t unix_event = (TsEventUnixRef_t)event;
+	__atomic_store_n( &(unix_event->_state), 0, __ATOMIC_SEQ_CST );
+
+	return TsStatusOk;
+}
+
+#if defined(TS_MUTEX_STATS)
+TsStatus_t ts_mutex_unix_stats( TsMutexRef_t mutex, TsMutexStats_t * stats ) {
+
+	ts_platform_assert( mutex != NULL );
+	ts_platform_assert( stats != NULL );
+
+	// a racy copy, the counters are only ever written by the owner
+	TsMutexUnixRef_t unix_mutex = (TsMutexUnixRef_t)mutex;
+	*stats = unix_mutex->_stats;
 
 	return TsStatusOk;
 }
+#endif
 #endif // TS_MUTEX_CUSTOM
@@ -0,0 +1,136 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#ifndef TS_MUTEX_UNIX_H
+#define TS_MUTEX_UNIX_H
+
+#include <stdint.h>
+
+#include "ts_mutex.h"
+
+// timeout value that blocks until the lock is acquired
+#define TS_MUTEX_UNIX_FOREVER UINT32_MAX
+
+typedef struct TsRwlock * TsRwlockRef_t;
+
+/**
+ * Attempt to acquire the given mutex (created by ts_mutex), waiting at most the given timeout.
+ * Tick paths use this to skip work rather than block while another thread holds the lock.
+ *
+ * @param mutex
+ * [in] The mutex.
+ *
+ * @param timeout
+ * [in] The time in microseconds to wait for the lock, zero does not wait at all.
+ *
+ * @return
+ * TsStatusOk                - The lock was acquired, release it with ts_mutex->unlock.
+ * TsStatusOkWritePending    - The lock is held elsewhere and the timeout expired.
+ * TsStatusError*            - Indicates an error has occurred, see ts_status.h for more information.
+ */
+TsStatus_t ts_mutex_unix_trylock( TsMutexRef_t mutex, uint32_t timeout );
+
+/**
+ * Allocate and initialize a reader-writer lock. Writers are preferred over new readers
+ * where the platform allows, so updates to read-mostly state are not starved.
+ */
+TsStatus_t ts_mutex_unix_rwlock_create( TsRwlockRef_t * rwlock );
+
+/**
+ * Deallocate the given reader-writer lock.
+ */
+TsStatus_t ts_mutex_unix_rwlock_destroy( TsRwlockRef_t rwlock );
+
+/**
+ * Acquire the given reader-writer lock shared (read_lock) or exclusive (write_lock).
+ *
+ * @param rwlock
+ * [in] The reader-writer lock.
+ *
+ * @param timeout
+ * [in] The time in microseconds to wait for the lock, zero does not wait at all,
+ *      TS_MUTEX_UNIX_FOREVER blocks until acquired.
+ *
+ * @return
+ * TsStatusOk                - The lock was acquired, release it with ts_mutex_unix_rwlock_unlock.
+ * TsStatusOkReadPending     - (read_lock) The lock is held exclusively and the timeout expired.
+ * TsStatusOkWritePending    - (write_lock) The lock is held and the timeout expired.
+ * TsStatusError*            - Indicates an error has occurred, see ts_status.h for more information.
+ */
+TsStatus_t ts_mutex_unix_read_lock( TsRwlockRef_t rwlock, uint32_t timeout );
+TsStatus_t ts_mutex_unix_write_lock( TsRwlockRef_t rwlock, uint32_t timeout );
+
+/**
+ * Release the given reader-writer lock, held either shared or exclusive.
+ */
+TsStatus_t ts_mutex_unix_rwlock_unlock( TsRwlockRef_t rwlock );
+
+typedef struct TsEvent * TsEventRef_t;
+
+/**
+ * Allocate and initialize an event, a manual reset flag that threads can wait on,
+ * e.g., for the application to learn that the sdk connected or delivered a message
+ * without polling in a sleep loop. Events are created clear.
+ */
+TsStatus_t ts_mutex_unix_event_create( TsEventRef_t * event );
+
+/**
+ * Deallocate the given event, there must be no waiters.
+ */
+TsStatus_t ts_mutex_unix_event_destroy( TsEventRef_t event );
+
+/**
+ * Wait for the given event to be set. Returns at once when it is already set.
+ *
+ * @param event
+ * [in] The event.
+ *
+ * @param timeout
+ * [in] The time in microseconds to wait, measured on the monotonic clock. Zero does not wait
+ *      at all, TS_MUTEX_UNIX_FOREVER waits until the event is set.
+ *
+ * @return
+ * TsStatusOk                - The event is set.
+ * TsStatusOkReadPending     - The timeout expired before the event was set.
+ * TsStatusError*            - Indicates an error has occurred, see ts_status.h for more information.
+ */
+TsStatus_t ts_mutex_unix_event_wait( TsEventRef_t event, uint32_t timeout );
+
+/**
+ * Set the given event and wake all of its waiters. The event stays set until reset.
+ */
+TsStatus_t ts_mutex_unix_event_notify( TsEventRef_t event );
+
+/**
+ * Clear the given event.
+ */
+TsStatus_t ts_mutex_unix_event_reset( TsEventRef_t event );
+
+#if defined(TS_MUTEX_STATS)
+
+typedef struct TsMutexStats {
+	uint64_t _acquisitions;
+	uint64_t _contended;     // acquisitions that found the mutex held
+	uint64_t _wait_usec;     // total time spent acquiring contended locks
+	uint64_t _max_wait_usec;
+	uint64_t _hold_usec;     // total time between lock and unlock
+	uint64_t _max_hold_usec;
+} TsMutexStats_t;
+
+/**
+ * Copy the contention statistics of the given mutex, enabled with TS_MUTEX_STATS.
+ *
+ * @param mutex
+ * [in] The mutex.
+ *
+ * @param stats
+ * [out] The statistics, see TsMutexStats_t.
+ *
+ * @return
+ * The return status (TsStatus_t) of the function, see ts_status.h for more information.
+ * - TsStatusOk
+ * - TsStatusError[Code]
+ */
+TsStatus_t ts_mutex_unix_stats( TsMutexRef_t mutex, TsMutexStats_t * stats );
+
+#endif // TS_MUTEX_STATS
+
+#endif // TS_MUTEX_UNIX_H
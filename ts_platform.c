@@ -1,6 +1,8 @@
 // Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 #if _POSIX_C_SOURCE >= 199309L
 #include <time.h>   // for nanosleep
@@ -10,10 +12,17 @@
 #if _POSIX_C_SOURCE < 200809L
 #include <sys/time.h>
 #endif
+#if defined(__linux__)
+#include <sys/syscall.h> // for getrandom
+#endif
+#if defined(TS_PLATFORM_POOL) || defined(TS_PLATFORM_ASYNC_LOG) || defined(TS_PLATFORM_STATS)
+#include <pthread.h>
+#endif
 
 // TODO - post compile-time warning if not a unix system
 
 #include "ts_platform.h"
+#include "ts_platform_unix.h"
 
 static void ts_initialize();
 static void ts_printf(const char *, ...);
@@ -38,36 +47,517 @@ static TsPlatformVtable_t ts_platform_unix = {
 };
 const TsPlatformVtable_t * ts_platform = &ts_platform_unix;
 
+#if defined(TS_PLATFORM_POOL)
+
+// size-class pool allocator, enabled with TS_PLATFORM_POOL
+//
+// the sdk allocates and frees many small objects of a handful of sizes
+// (drivers, mutexes, messages, read buffers), and always tells ts_free how
+// big the block was. each size class owns one contiguous arena carved into
+// fixed size blocks with an intrusive free list, so blocks carry no header
+// and the arena never fragments. requests larger than the largest class,
+// or made while a class is exhausted, fall through to libc.
+
+#ifndef TS_PLATFORM_POOL_BLOCKS
+#define TS_PLATFORM_POOL_BLOCKS 256
+#endif
+#define TS_PLATFORM_POOL_CLASSES 8
+#define TS_PLATFORM_POOL_MIN_SHIFT 4
+
+typedef struct TsPlatformPoolBlock {
+	struct TsPlatformPoolBlock * _next;
+} TsPlatformPoolBlock_t;
+
+typedef struct TsPlatformPool {
+	pthread_mutex_t _mutex;
+	size_t _block_size;
+	uint8_t * _base;
+	uint8_t * _limit;
+	TsPlatformPoolBlock_t * _free;
+} TsPlatformPool_t;
+
+static TsPlatformPool_t _pool[ TS_PLATFORM_POOL_CLASSES ];
+static pthread_once_t _pool_once = PTHREAD_ONCE_INIT;
+
+static void _ts_pool_initialize() {
+
+	for( int index = 0; index < TS_PLATFORM_POOL_CLASSES; index++ ) {
+
+		TsPlatformPool_t * pool = &( _pool[ index ] );
+		pthread_mutex_init( &( pool->_mutex ), NULL );
+		pool->_block_size = (size_t) 1 << ( TS_PLATFORM_POOL_MIN_SHIFT + index );
+		pool->_base = (uint8_t *) malloc( pool->_block_size * TS_PLATFORM_POOL_BLOCKS );
+		pool->_limit = pool->_base;
+		pool->_free = NULL;
+		if( pool->_base == NULL ) {
+			// class stays empty, every request falls through to libc
+			continue;
+		}
+		pool->_limit = pool->_base + pool->_block_size * TS_PLATFORM_POOL_BLOCKS;
+
+		// thread the free list through the arena, lowest address first
+		for( uint8_t * block = pool->_limit - pool->_block_size; block >= pool->_base; block = block - pool->_block_size ) {
+			( (TsPlatformPoolBlock_t *) block )->_next = pool->_free;
+			pool->_free = (TsPlatformPoolBlock_t *) block;
+			if( block == pool->_base ) {
+				break;
+			}
+		}
+	}
+}
+
+static int _ts_pool_class( size_t size ) {
+
+	int index = 0;
+	size_t block_size = (size_t) 1 << TS_PLATFORM_POOL_MIN_SHIFT;
+	while( block_size < size ) {
+		block_size = block_size << 1;
+		index = index + 1;
+	}
+	return ( index < TS_PLATFORM_POOL_CLASSES ) ? index : -1;
+}
+
+static bool _ts_pool_owns( TsPlatformPool_t * pool, void * pointer ) {
+	return (uint8_t *) pointer >= pool->_base && (uint8_t *) pointer < pool->_limit;
+}
+
+static void * _ts_pool_malloc( size_t size ) {
+
+	pthread_once( &_pool_once, _ts_pool_initialize );
+
+	int index = _ts_pool_class( size );
+	if( index < 0 ) {
+		return malloc( size );
+	}
+
+	TsPlatformPool_t * pool = &( _pool[ index ] );
+	pthread_mutex_lock( &( pool->_mutex ) );
+	TsPlatformPoolBlock_t * block = pool->_free;
+	if( block != NULL ) {
+		pool->_free = block->_next;
+	}
+	pthread_mutex_unlock( &( pool->_mutex ) );
+
+	if( block == NULL ) {
+		// class exhausted
+		return malloc( size );
+	}
+	return (void *) block;
+}
+
+static void _ts_pool_free( void * pointer, size_t size ) {
+
+	if( pointer == NULL ) {
+		return;
+	}
+	pthread_once( &_pool_once, _ts_pool_initialize );
+
+	// the size selects the class; the range check guards against
+	// callers that report a different size than they allocated
+	TsPlatformPool_t * pool = NULL;
+	int index = _ts_pool_class( size );
+	if( index >= 0 && _ts_pool_owns( &( _pool[ index ] ), pointer ) ) {
+		pool = &( _pool[ index ] );
+	} else {
+		for( index = 0; index < TS_PLATFORM_POOL_CLASSES; index++ ) {
+			if( _ts_pool_owns( &( _pool[ index ] ), pointer ) ) {
+				pool = &( _pool[ index ] );
+				break;
+			}
+		}
+	}
+	if( pool == NULL ) {
+		free( pointer );
+		return;
+	}
+
+	TsPlatformPoolBlock_t * block = (TsPlatformPoolBlock_t *) pointer;
+	pthread_mutex_lock( &( pool->_mutex ) );
+	block->_next = pool->_free;
+	pool->_free = block;
+	pthread_mutex_unlock( &( pool->_mutex ) );
+}
+
+#endif // TS_PLATFORM_POOL
+
+#if defined(TS_PLATFORM_STATS)
+
+// allocation accounting, enabled with TS_PLATFORM_STATS
+//
+// counts live and peak bytes, per size class totals and a histogram of the
+// call sites of ts_malloc. ts_free only knows the size of the block, so the
+// site histogram is cumulative while the class counters track live blocks.
+
+static TsPlatformStats_t _stats;
+static pthread_once_t _stats_once = PTHREAD_ONCE_INIT;
+
+static void _ts_stats_initialize() {
+	// report on exit, including the exit taken by ts_assertion
+	atexit( ts_platform_unix_stats_report );
+}
+
+static int _ts_stats_class( size_t size ) {
+
+	int index = 0;
+	size_t block_size = 16;
+	while( block_size < size && index < TS_PLATFORM_STATS_CLASSES - 1 ) {
+		block_size = block_size << 1;
+		index = index + 1;
+	}
+	return index;
+}
+
+static void _ts_stats_malloc( void * site, size_t size ) {
+
+	int64_t live = __atomic_add_fetch( &( _stats._live_bytes ), (int64_t) size, __ATOMIC_RELAXED );
+	int64_t peak = __atomic_load_n( &( _stats._peak_bytes ), __ATOMIC_RELAXED );
+	while( live > peak && !__atomic_compare_exchange_n( &( _stats._peak_bytes ), &peak, live, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ));
+
+	int index = _ts_stats_class( size );
+	__atomic_add_fetch( &( _stats._allocations ), 1, __ATOMIC_RELAXED );
+	__atomic_add_fetch( &( _stats._class_live[ index ] ), 1, __ATOMIC_RELAXED );
+	__atomic_add_fetch( &( _stats._class_allocations[ index ] ), 1, __ATOMIC_RELAXED );
+
+	// open addressing on the return address, a full table drops the sample
+	size_t slot = ( (uintptr_t) site >> 2 ) % TS_PLATFORM_STATS_SITES;
+	for( size_t probe = 0; probe < TS_PLATFORM_STATS_SITES; probe++ ) {
+
+		TsPlatformStatsSite_t * entry = &( _stats._sites[ ( slot + probe ) % TS_PLATFORM_STATS_SITES ] );
+		void * current = __atomic_load_n( &( entry->_site ), __ATOMIC_ACQUIRE );
+		if( current == NULL ) {
+			__atomic_compare_exchange_n( &( entry->_site ), &current, site, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+		}
+		if( current == NULL || current == site ) {
+			__atomic_add_fetch( &( entry->_allocations ), 1, __ATOMIC_RELAXED );
+			__atomic_add_fetch( &( entry->_bytes ), (uint64_t) size, __ATOMIC_RELAXED );
+			break;
+		}
+	}
+}
+
+static void _ts_stats_free( size_t size ) {
+
+	__atomic_sub_fetch( &( _stats._live_bytes ), (int64_t) size, __ATOMIC_RELAXED );
+	__atomic_add_fetch( &( _stats._frees ), 1, __ATOMIC_RELAXED );
+	__atomic_sub_fetch( &( _stats._class_live[ _ts_stats_class( size ) ] ), 1, __ATOMIC_RELAXED );
+}
+
+void ts_platform_unix_stats( TsPlatformStats_t * stats ) {
+
+	stats->_live_bytes = __atomic_load_n( &( _stats._live_bytes ), __ATOMIC_RELAXED );
+	stats->_peak_bytes = __atomic_load_n( &( _stats._peak_bytes ), __ATOMIC_RELAXED );
+	stats->_allocations = __atomic_load_n( &( _stats._allocations ), __ATOMIC_RELAXED );
+	stats->_frees = __atomic_load_n( &( _stats._frees ), __ATOMIC_RELAXED );
+	for( int index = 0; index < TS_PLATFORM_STATS_CLASSES; index++ ) {
+		stats->_class_live[ index ] = __atomic_load_n( &( _stats._class_live[ index ] ), __ATOMIC_RELAXED );
+		stats->_class_allocations[ index ] = __atomic_load_n( &( _stats._class_allocations[ index ] ), __ATOMIC_RELAXED );
+	}
+	for( int index = 0; index < TS_PLATFORM_STATS_SITES; index++ ) {
+		stats->_sites[ index ]._site = __atomic_load_n( &( _stats._sites[ index ]._site ), __ATOMIC_ACQUIRE );
+		stats->_sites[ index ]._allocations = __atomic_load_n( &( _stats._sites[ index ]._allocations ), __ATOMIC_RELAXED );
+		stats->_sites[ index ]._bytes = __atomic_load_n( &( _stats._sites[ index ]._bytes ), __ATOMIC_RELAXED );
+	}
+}
+
+void ts_platform_unix_stats_report() {
+
+	TsPlatformStats_t stats;
+	ts_platform_unix_stats( &stats );
+
+	printf( "ts_platform: live %lld bytes, peak %lld bytes, %llu allocations, %llu frees\n",
+		(long long) stats._live_bytes, (long long) stats._peak_bytes,
+		(unsigned long long) stats._allocations, (unsigned long long) stats._frees );
+	for( int index = 0; index < TS_PLATFORM_STATS_CLASSES; index++ ) {
+		if( stats._class_allocations[ index ] > 0 ) {
+			printf( "ts_platform: %s%5u bytes, %lld live, %llu allocations\n",
+				( index == TS_PLATFORM_STATS_CLASSES - 1 ) ? ">" : "<=",
+				(unsigned) ( 16 << ( index < TS_PLATFORM_STATS_CLASSES - 1 ? index : index - 1 )),
+				(long long) stats._class_live[ index ], (unsigned long long) stats._class_allocations[ index ] );
+		}
+	}
+
+	// selection sort the few sites we print by allocated bytes
+	for( int count = 0; count < 10; count++ ) {
+		int busiest = -1;
+		for( int index = 0; index < TS_PLATFORM_STATS_SITES; index++ ) {
+			if( stats._sites[ index ]._site != NULL && ( busiest < 0 || stats._sites[ index ]._bytes > stats._sites[ busiest ]._bytes )) {
+				busiest = index;
+			}
+		}
+		if( busiest < 0 ) {
+			break;
+		}
+		printf( "ts_platform: site %p, %llu allocations, %llu bytes\n", stats._sites[ busiest ]._site,
+			(unsigned long long) stats._sites[ busiest ]._allocations, (unsigned long long) stats._sites[ busiest ]._bytes );
+		stats._sites[ busiest ]._site = NULL;
+	}
+	fflush( stdout );
+}
+
+#endif // TS_PLATFORM_STATS
+
+#if defined(TS_PLATFORM_ASYNC_LOG)
+
+// asynchronous logging, enabled with TS_PLATFORM_ASYNC_LOG
+//
+// ts_vprintf formats straight into a slot of a bounded multi-producer,
+// multi-consumer ring (sequence numbered slots, no locks), and a background
+// thread drains the ring to stdout in batches with a single flush. when the
+// ring is full the message is dropped and counted, the drain thread reports
+// the number dropped. lines longer than a slot are truncated.
+
+#ifndef TS_PLATFORM_LOG_SLOTS
+#define TS_PLATFORM_LOG_SLOTS 256 // must be a power of two
+#endif
+#ifndef TS_PLATFORM_LOG_LINE_SIZE
+#define TS_PLATFORM_LOG_LINE_SIZE 256
+#endif
+#define TS_PLATFORM_LOG_BATCH_SIZE 4096
+#define TS_PLATFORM_LOG_IDLE_USEC 100000
+
+typedef struct TsPlatformLogSlot {
+	size_t _sequence;
+	size_t _length;
+	char _text[ TS_PLATFORM_LOG_LINE_SIZE ];
+} TsPlatformLogSlot_t;
+
+static TsPlatformLogSlot_t _log_slots[ TS_PLATFORM_LOG_SLOTS ];
+static size_t _log_head;
+static size_t _log_tail;
+static uint64_t _log_written;
+static uint64_t _log_dropped;
+static uint64_t _log_dropped_reported;
+static int _log_sleeping;
+static pthread_mutex_t _log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t _log_output_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _log_condition = PTHREAD_COND_INITIALIZER;
+static pthread_once_t _log_once = PTHREAD_ONCE_INIT;
+
+static bool _ts_log_pop( char * text, size_t * length ) {
+
+	TsPlatformLogSlot_t * slot;
+	size_t position = __atomic_load_n( &_log_tail, __ATOMIC_RELAXED );
+	for(;;) {
+		slot = &( _log_slots[ position & ( TS_PLATFORM_LOG_SLOTS - 1 ) ] );
+		size_t sequence = __atomic_load_n( &( slot->_sequence ), __ATOMIC_ACQUIRE );
+		intptr_t difference = (intptr_t) sequence - (intptr_t) ( position + 1 );
+		if( difference == 0 ) {
+			if( __atomic_compare_exchange_n( &_log_tail, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED )) {
+				break;
+			}
+		} else if( difference < 0 ) {
+			// empty
+			return false;
+		} else {
+			position = __atomic_load_n( &_log_tail, __ATOMIC_RELAXED );
+		}
+	}
+	*length = slot->_length;
+	memcpy( text, slot->_text, slot->_length );
+	__atomic_store_n( &( slot->_sequence ), position + TS_PLATFORM_LOG_SLOTS, __ATOMIC_RELEASE );
+	return true;
+}
+
+static void _ts_log_drain() {
+
+	char batch[ TS_PLATFORM_LOG_BATCH_SIZE ];
+	size_t index = 0;
+	size_t length;
+
+	// serialize output, the drain thread and ts_assertion may both drain
+	pthread_mutex_lock( &_log_output_mutex );
+	while( _ts_log_pop( batch + index, &length )) {
+		index = index + length;
+		if( index > TS_PLATFORM_LOG_BATCH_SIZE - TS_PLATFORM_LOG_LINE_SIZE ) {
+			fwrite( batch, 1, index, stdout );
+			index = 0;
+		}
+	}
+	if( index > 0 ) {
+		fwrite( batch, 1, index, stdout );
+	}
+	uint64_t dropped = __atomic_load_n( &_log_dropped, __ATOMIC_RELAXED );
+	if( dropped != _log_dropped_reported ) {
+		fprintf( stdout, "ts_platform: %llu log messages dropped\n", (unsigned long long) ( dropped - _log_dropped_reported ));
+		_log_dropped_reported = dropped;
+	}
+	fflush( stdout );
+	pthread_mutex_unlock( &_log_output_mutex );
+}
+
+static void * _ts_log_thread( void * argument ) {
+
+	for(;;) {
+
+		_ts_log_drain();
+
+		// announce the sleep before re-checking, producers look at the flag after publishing
+		pthread_mutex_lock( &_log_mutex );
+		__atomic_store_n( &_log_sleeping, 1, __ATOMIC_SEQ_CST );
+		size_t position = __atomic_load_n( &_log_tail, __ATOMIC_SEQ_CST );
+		size_t sequence = __atomic_load_n( &( _log_slots[ position & ( TS_PLATFORM_LOG_SLOTS - 1 ) ]._sequence ), __ATOMIC_SEQ_CST );
+		if( sequence != position + 1 ) {
+			struct timespec deadline;
+			clock_gettime( CLOCK_REALTIME, &deadline );
+			deadline.tv_nsec = deadline.tv_nsec + TS_PLATFORM_LOG_IDLE_USEC * TS_TIME_USEC_TO_NSEC;
+			if( deadline.tv_nsec >= 1000000000L ) {
+				deadline.tv_sec = deadline.tv_sec + 1;
+				deadline.tv_nsec = deadline.tv_nsec - 1000000000L;
+			}
+			pthread_cond_timedwait( &_log_condition, &_log_mutex, &deadline );
+		}
+		__atomic_store_n( &_log_sleeping, 0, __ATOMIC_SEQ_CST );
+		pthread_mutex_unlock( &_log_mutex );
+	}
+	return NULL;
+}
+
+static void _ts_log_exit() {
+	_ts_log_drain();
+}
+
+static void _ts_log_initialize() {
+
+	for( size_t index = 0; index < TS_PLATFORM_LOG_SLOTS; index++ ) {
+		_log_slots[ index ]._sequence = index;
+	}
+
+	pthread_t thread;
+	if( pthread_create( &thread, NULL, _ts_log_thread, NULL ) == 0 ) {
+		pthread_detach( thread );
+	}
+	atexit( _ts_log_exit );
+}
+
+static void _ts_log_vprintf( const char * format, va_list argp ) {
+
+	pthread_once( &_log_once, _ts_log_initialize );
+
+	TsPlatformLogSlot_t * slot;
+	size_t position = __atomic_load_n( &_log_head, __ATOMIC_RELAXED );
+	for(;;) {
+		slot = &( _log_slots[ position & ( TS_PLATFORM_LOG_SLOTS - 1 ) ] );
+		size_t sequence = __atomic_load_n( &( slot->_sequence ), __ATOMIC_ACQUIRE );
+		intptr_t difference = (intptr_t) sequence - (intptr_t) position;
+		if( difference == 0 ) {
+			if( __atomic_compare_exchange_n( &_log_head, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED )) {
+				break;
+			}
+		} else if( difference < 0 ) {
+			// full, drop the message rather than block the caller
+			__atomic_add_fetch( &_log_dropped, 1, __ATOMIC_RELAXED );
+			return;
+		} else {
+			position = __atomic_load_n( &_log_head, __ATOMIC_RELAXED );
+		}
+	}
+
+	int length = vsnprintf( slot->_text, TS_PLATFORM_LOG_LINE_SIZE, format, argp );
+	if( length < 0 ) {
+		length = 0;
+	} else if( length >= TS_PLATFORM_LOG_LINE_SIZE ) {
+		length = TS_PLATFORM_LOG_LINE_SIZE - 1;
+	}
+	slot->_length = (size_t) length;
+	__atomic_store_n( &( slot->_sequence ), position + 1, __ATOMIC_SEQ_CST );
+	__atomic_add_fetch( &_log_written, 1, __ATOMIC_RELAXED );
+
+	// wake the drain thread only when it is waiting
+	if( __atomic_load_n( &_log_sleeping, __ATOMIC_SEQ_CST )) {
+		pthread_mutex_lock( &_log_mutex );
+		pthread_cond_signal( &_log_condition );
+		pthread_mutex_unlock( &_log_mutex );
+	}
+}
+
+void ts_platform_unix_log_stats( uint64_t * written, uint64_t * dropped ) {
+	*written = __atomic_load_n( &_log_written, __ATOMIC_RELAXED );
+	*dropped = __atomic_load_n( &_log_dropped, __ATOMIC_RELAXED );
+}
+
+#endif // TS_PLATFORM_ASYNC_LOG
+
 static void ts_initialize() {
-    // do nothing
+#if defined(TS_PLATFORM_STATS)
+    // registered once, however often the platform is initialized
+    pthread_once( &_stats_once, _ts_stats_initialize );
+#endif
 }
 
 static void ts_printf(const char * format, ...) {
     va_list argp;
 	va_start(argp, format);
-    vprintf(format, argp);
+    ts_vprintf(format, argp);
 	va_end(argp);
-    fflush(stdout);
 }
 
 static void ts_vprintf(const char * format, va_list argp) {
+#if defined(TS_PLATFORM_ASYNC_LOG)
+    _ts_log_vprintf(format, argp);
+#else
     vprintf(format, argp);
     fflush(stdout);
+#endif
 }
 
-// TODO - does this work the same on linux vs mac? monotonic increasing time?
-static uint64_t ts_time() {
-    uint64_t microseconds;
 #if _POSIX_C_SOURCE >= 200809L
+// CLOCK_MONOTONIC is served from the vdso on linux, so it costs no syscall and
+// is never stepped by ntp; budgets computed from ts_time stay honest across
+// clock adjustments. define TS_PLATFORM_CLOCK as CLOCK_MONOTONIC_RAW to also
+// ignore ntp frequency slewing.
+#if !defined(TS_PLATFORM_CLOCK)
+#if defined(CLOCK_MONOTONIC)
+#define TS_PLATFORM_CLOCK CLOCK_MONOTONIC
+#else
+#define TS_PLATFORM_CLOCK CLOCK_REALTIME
+#endif
+#endif
+// the coarse clock returns the time of the last scheduler tick without
+// reading the hardware counter, at the resolution of a jiffy
+#if !defined(TS_PLATFORM_CLOCK_COARSE)
+#if defined(CLOCK_MONOTONIC_COARSE)
+#define TS_PLATFORM_CLOCK_COARSE CLOCK_MONOTONIC_COARSE
+#else
+#define TS_PLATFORM_CLOCK_COARSE TS_PLATFORM_CLOCK
+#endif
+#endif
+
+static uint64_t _ts_clock( clockid_t clock ) {
     struct timespec spec;
-    clock_gettime(CLOCK_REALTIME, &spec);
-    microseconds = (uint64_t)(spec.tv_sec) * TS_TIME_SEC_TO_USEC + (uint64_t)(spec.tv_nsec) / TS_TIME_USEC_TO_NSEC;
+    clock_gettime(clock, &spec);
+    return (uint64_t)(spec.tv_sec) * TS_TIME_SEC_TO_USEC + (uint64_t)(spec.tv_nsec) / TS_TIME_USEC_TO_NSEC;
+}
 #else
+static uint64_t _ts_gettimeofday() {
     struct timeval tv;
     gettimeofday(&tv, NULL);
-    microseconds = (uint64_t)(tv.tv_sec) * TS_TIME_SEC_TO_USEC + (uint64_t)(tv.tv_usec);
+    return (uint64_t)(tv.tv_sec) * TS_TIME_SEC_TO_USEC + (uint64_t)(tv.tv_usec);
+}
+#endif
+
+// monotonic time in microseconds, not related to the calendar
+static uint64_t ts_time() {
+#if _POSIX_C_SOURCE >= 200809L
+    return _ts_clock( TS_PLATFORM_CLOCK );
+#else
+    return _ts_gettimeofday();
+#endif
+}
+
+uint64_t ts_platform_unix_time_coarse() {
+#if _POSIX_C_SOURCE >= 200809L
+    return _ts_clock( TS_PLATFORM_CLOCK_COARSE );
+#else
+    return _ts_gettimeofday();
+#endif
+}
+
+uint64_t ts_platform_unix_wallclock() {
+#if _POSIX_C_SOURCE >= 200809L
+    return _ts_clock( CLOCK_REALTIME );
+#else
+    return _ts_gettimeofday();
 #endif
-    return microseconds;
 }
 
 static void ts_sleep(uint32_t microseconds) {
@@ -81,20 +571,121 @@ static void ts_sleep(uint32_t microseconds) {
 #endif
 }
 
+// per-thread xoshiro128** generator, seeded once per thread from the kernel
+//
+// fast and well distributed, but not cryptographically secure; key material
+// and tls nonces come from the mbedtls drbg, not from here.
+static __thread uint32_t _random_state[ 4 ];
+static __thread bool _random_seeded = false;
+
+static uint32_t _ts_random_rotl( uint32_t value, int shift ) {
+    return ( value << shift ) | ( value >> ( 32 - shift ));
+}
+
+static void _ts_random_seed() {
+
+    size_t size = 0;
+#if defined(__linux__) && defined(SYS_getrandom)
+    long result = syscall( SYS_getrandom, _random_state, sizeof( _random_state ), 0 );
+    if( result > 0 ) {
+        size = (size_t) result;
+    }
+#endif
+    if( size < sizeof( _random_state )) {
+        int fd = open( "/dev/urandom", O_RDONLY );
+        if( fd >= 0 ) {
+            ssize_t result = read( fd, _random_state, sizeof( _random_state ));
+            size = ( result > 0 ) ? (size_t) result : 0;
+            close( fd );
+        }
+    }
+    if( size < sizeof( _random_state )) {
+        // last resort, the time and the address of this thread's state
+        uint64_t seed = ts_time() ^ (uint64_t) (uintptr_t) _random_state;
+        for( int index = 0; index < 4; index++ ) {
+            // splitmix64
+            uint64_t mix = ( seed += 0x9E3779B97F4A7C15ULL );
+            mix = ( mix ^ ( mix >> 30 )) * 0xBF58476D1CE4E5B9ULL;
+            mix = ( mix ^ ( mix >> 27 )) * 0x94D049BB133111EBULL;
+            _random_state[ index ] = (uint32_t) ( mix ^ ( mix >> 31 ));
+        }
+    }
+    if( ( _random_state[ 0 ] | _random_state[ 1 ] | _random_state[ 2 ] | _random_state[ 3 ] ) == 0 ) {
+        // the all zero state is a fixed point
+        _random_state[ 0 ] = 1;
+    }
+    _random_seeded = true;
+}
+
+static uint32_t _ts_random_next() {
+
+    if( !_random_seeded ) {
+        _ts_random_seed();
+    }
+    uint32_t * state = _random_state;
+    uint32_t result = _ts_random_rotl( state[ 1 ] * 5, 7 ) * 9;
+    uint32_t shifted = state[ 1 ] << 9;
+    state[ 2 ] ^= state[ 0 ];
+    state[ 3 ] ^= state[ 1 ];
+    state[ 1 ] ^= state[ 2 ];
+    state[ 0 ] ^= state[ 3 ];
+    state[ 2 ] ^= shifted;
+    state[ 3 ] = _ts_random_rotl( state[ 3 ], 11 );
+    return result;
+}
+
 static void ts_random(uint32_t * number) {
-    srand((int)ts_time());
-    *number = (uint32_t)(rand()%(2^32-1));
+    *number = _ts_random_next();
+}
+
+void ts_platform_unix_random_fill( void * buffer, size_t size ) {
+
+    uint8_t * bytes = (uint8_t *) buffer;
+    while( size >= sizeof( uint32_t )) {
+        uint32_t number = _ts_random_next();
+        memcpy( bytes, &number, sizeof( uint32_t ));
+        bytes = bytes + sizeof( uint32_t );
+        size = size - sizeof( uint32_t );
+    }
+    if( size > 0 ) {
+        uint32_t number = _ts_random_next();
+        memcpy( bytes, &number, size );
+    }
 }
 
 static void * ts_malloc(size_t size) {
-    return malloc( size );
+    void * pointer;
+#if defined(TS_PLATFORM_POOL)
+    pointer = _ts_pool_malloc( size );
+#else
+    pointer = malloc( size );
+#endif
+#if defined(TS_PLATFORM_STATS)
+    if( pointer != NULL ) {
+        _ts_stats_malloc( __builtin_return_address( 0 ), size );
+    }
+#endif
+    return pointer;
 }
 
 static void ts_free(void * pointer, size_t size) {
-    return free( pointer );
+#if defined(TS_PLATFORM_STATS)
+    if( pointer != NULL ) {
+        _ts_stats_free( size );
+    }
+#endif
+#if defined(TS_PLATFORM_POOL)
+    _ts_pool_free( pointer, size );
+#else
+    free( pointer );
+#endif
 }
 
 static void ts_assertion(const char *msg, const char *file, int line) {
+#if defined(TS_PLATFORM_ASYNC_LOG)
+    // flush what was logged before the failure, synchronously
+    _ts_log_drain();
+#endif
     printf("assertion failed, '%s' at %s:%d\n", msg, file, line);
     fflush(stdout);
     exit(0);
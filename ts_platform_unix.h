@@ -0,0 +1,82 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#ifndef TS_PLATFORM_UNIX_H
+#define TS_PLATFORM_UNIX_H
+
+#include "ts_platform.h"
+
+/**
+ * Return a monotonic time in microseconds that is cheaper to read than ts_platform_time,
+ * at the cost of resolution (one scheduler tick, typically 1 to 10 milliseconds).
+ * Suitable for budget checks in tight loops; shares the time base of ts_platform_time
+ * unless TS_PLATFORM_CLOCK was overridden.
+ */
+uint64_t ts_platform_unix_time_coarse();
+
+/**
+ * Return the wall clock time in microseconds since the unix epoch. Unlike ts_platform_time
+ * this may jump when the system clock is set, use it only for timestamps that are reported.
+ */
+uint64_t ts_platform_unix_wallclock();
+
+/**
+ * Fill the given buffer with pseudo-random bytes from the calling thread's generator,
+ * the same generator that serves ts_platform_random. No syscall or lock is taken per value.
+ * The generator is not cryptographically secure.
+ *
+ * @param buffer
+ * [out] The memory to fill.
+ *
+ * @param size
+ * [in] The number of bytes to fill.
+ */
+void ts_platform_unix_random_fill( void * buffer, size_t size );
+
+#if defined(TS_PLATFORM_ASYNC_LOG)
+
+/**
+ * Return the number of messages accepted by, and dropped from, the asynchronous log ring.
+ */
+void ts_platform_unix_log_stats( uint64_t * written, uint64_t * dropped );
+
+#endif // TS_PLATFORM_ASYNC_LOG
+
+#if defined(TS_PLATFORM_STATS)
+
+// size classes are powers of two from 16 bytes, the last class counts everything larger
+#define TS_PLATFORM_STATS_CLASSES 9
+#define TS_PLATFORM_STATS_SITES 64
+
+typedef struct TsPlatformStatsSite {
+	void * _site;
+	uint64_t _allocations;
+	uint64_t _bytes;
+} TsPlatformStatsSite_t;
+
+typedef struct TsPlatformStats {
+	int64_t _live_bytes;
+	int64_t _peak_bytes;
+	uint64_t _allocations;
+	uint64_t _frees;
+	int64_t _class_live[ TS_PLATFORM_STATS_CLASSES ];
+	uint64_t _class_allocations[ TS_PLATFORM_STATS_CLASSES ];
+	TsPlatformStatsSite_t _sites[ TS_PLATFORM_STATS_SITES ];
+} TsPlatformStats_t;
+
+/**
+ * Copy the current allocation counters. The copy is not atomic with respect
+ * to concurrent allocations, each counter is individually consistent.
+ *
+ * @param stats
+ * [out] The allocation counters, see TsPlatformStats_t.
+ */
+void ts_platform_unix_stats( TsPlatformStats_t * stats );
+
+/**
+ * Print the allocation counters, size classes and the busiest allocation sites.
+ * Sites are caller return addresses, resolve them with addr2line.
+ */
+void ts_platform_unix_stats_report();
+
+#endif // TS_PLATFORM_STATS
+
+#endif // TS_PLATFORM_UNIX_H
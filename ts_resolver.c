@@ -0,0 +1,339 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#if defined(TS_DRIVER_SOCKET)
+#include <netdb.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "ts_platform.h"
+#include "ts_resolver.h"
+
+// resolution cache
+//
+// a small table of resolutions keyed by host, port and the hints that shape the
+// result. entries hold a private copy of the address list, callers get their own
+// copy so an entry can be replaced while a connect is still walking the old one.
+// once an entry is past its ttl (but within the stale window), the first resolve
+// starts a detached refresh thread and everyone keeps using the stale copy until
+// the refresh lands. failures are cached for the negative ttl, and a failed
+// refresh is not retried before the negative ttl passed either.
+
+typedef struct TsResolverEntry {
+
+	char _host[ TS_RESOLVER_MAX_HOST_SIZE ];
+	char _port[ TS_RESOLVER_MAX_PORT_SIZE ];
+	int _family;
+	int _socktype;
+	int _protocol;
+	uint64_t _expires;      // fresh until
+	uint64_t _retry;        // no refresh is started before, after a failed one
+	uint64_t _used;         // for least recently used replacement
+	bool _valid;
+	bool _refreshing;
+	struct addrinfo * _list;    // NULL for a failed resolution
+
+} TsResolverEntry_t;
+
+// one allocation per address, the address is kept next to its addrinfo
+typedef struct TsResolverAddress {
+
+	struct addrinfo _info;
+	struct sockaddr_storage _address;
+
+} TsResolverAddress_t;
+
+typedef struct TsResolverRefresh {
+
+	TsResolverEntry_t _key;
+	TsResolverLookup_t _lookup;
+	TsResolverRelease_t _release;
+
+} TsResolverRefresh_t;
+
+static pthread_mutex_t _resolver_mutex = PTHREAD_MUTEX_INITIALIZER;
+static TsResolverConfig_t _resolver_config = { 0, 0, 0, NULL, NULL };
+static TsResolverEntry_t _resolver_entries[ TS_RESOLVER_ENTRIES ];
+
+static int _ts_resolver_lookup( const char * host, const char * port, const struct addrinfo * hints, struct addrinfo ** result ) {
+	return getaddrinfo( host, port, hints, result );
+}
+
+static void _ts_resolver_release( struct addrinfo * result ) {
+	freeaddrinfo( result );
+}
+
+/**
+ * Copy the given address list into a single allocation, the copy has no canonical names.
+ */
+static struct addrinfo * _ts_resolver_copy( const struct addrinfo * list ) {
+
+	size_t count = 0;
+	for( const struct addrinfo * current = list; current != NULL; current = current->ai_next ) {
+		if( current->ai_addrlen <= sizeof( struct sockaddr_storage )) {
+			count = count + 1;
+		}
+	}
+	if( count == 0 ) {
+		return NULL;
+	}
+
+	TsResolverAddress_t * copy = (TsResolverAddress_t *) ts_platform_malloc( count * sizeof( TsResolverAddress_t ));
+	if( copy == NULL ) {
+		return NULL;
+	}
+	size_t index = 0;
+	for( const struct addrinfo * current = list; current != NULL; current = current->ai_next ) {
+		if( current->ai_addrlen > sizeof( struct sockaddr_storage )) {
+			continue;
+		}
+		copy[ index ]._info = *current;
+		copy[ index ]._info.ai_canonname = NULL;
+		copy[ index ]._info.ai_addr = (struct sockaddr *) &( copy[ index ]._address );
+		copy[ index ]._info.ai_next = ( index + 1 < count ) ? &( copy[ index + 1 ]._info ) : NULL;
+		memcpy( &( copy[ index ]._address ), current->ai_addr, current->ai_addrlen );
+		index = index + 1;
+	}
+	return &( copy[ 0 ]._info );
+}
+
+static void _ts_resolver_free( struct addrinfo * list ) {
+
+	size_t count = 0;
+	for( struct addrinfo * current = list; current != NULL; current = current->ai_next ) {
+		count = count + 1;
+	}
+	if( count > 0 ) {
+		ts_platform_free( list, count * sizeof( TsResolverAddress_t ));
+	}
+}
+
+static bool _ts_resolver_match( const TsResolverEntry_t * entry, const char * host, const char * port, const struct addrinfo * hints ) {
+
+	return entry->_valid &&
+		entry->_family == hints->ai_family &&
+		entry->_socktype == hints->ai_socktype &&
+		entry->_protocol == hints->ai_protocol &&
+		strcmp( entry->_host, host ) == 0 &&
+		strcmp( entry->_port, port ) == 0;
+}
+
+static TsResolverEntry_t * _ts_resolver_find( const char * host, const char * port, const struct addrinfo * hints ) {
+
+	for( int i = 0; i < TS_RESOLVER_ENTRIES; i++ ) {
+		if( _ts_resolver_match( &( _resolver_entries[ i ] ), host, port, hints )) {
+			return &( _resolver_entries[ i ] );
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Store the given resolution (NULL for a failure) for the given key, replacing the existing
+ * entry or the least recently used one. Called with the mutex held.
+ */
+static void _ts_resolver_store( const char * host, const char * port, const struct addrinfo * hints, struct addrinfo * list, uint64_t now ) {
+
+	TsResolverEntry_t * entry = _ts_resolver_find( host, port, hints );
+	if( entry == NULL ) {
+		entry = &( _resolver_entries[ 0 ] );
+		for( int i = 0; i < TS_RESOLVER_ENTRIES && entry->_valid; i++ ) {
+			if( !_resolver_entries[ i ]._valid || _resolver_entries[ i ]._used < entry->_used ) {
+				entry = &( _resolver_entries[ i ] );
+			}
+		}
+		if( entry->_valid && entry->_list != NULL ) {
+			_ts_resolver_free( entry->_list );
+		}
+		snprintf( entry->_host, TS_RESOLVER_MAX_HOST_SIZE, "%s", host );
+		snprintf( entry->_port, TS_RESOLVER_MAX_PORT_SIZE, "%s", port );
+		entry->_family = hints->ai_family;
+		entry->_socktype = hints->ai_socktype;
+		entry->_protocol = hints->ai_protocol;
+		entry->_used = now;
+		entry->_valid = true;
+	} else if( entry->_list != NULL ) {
+		_ts_resolver_free( entry->_list );
+	}
+
+	uint32_t ttl = ( list != NULL ) ? _resolver_config._ttl : _resolver_config._negative_ttl;
+	entry->_list = list;
+	entry->_expires = now + (uint64_t) ttl * TS_TIME_SEC_TO_USEC;
+	entry->_retry = 0;
+	entry->_refreshing = false;
+}
+
+static void * _ts_resolver_thread( void * argument ) {
+
+	TsResolverRefresh_t * refresh = (TsResolverRefresh_t *) argument;
+	TsResolverEntry_t * key = &( refresh->_key );
+
+	struct addrinfo hints;
+	memset( &hints, 0x00, sizeof( struct addrinfo ));
+	hints.ai_family = key->_family;
+	hints.ai_socktype = key->_socktype;
+	hints.ai_protocol = key->_protocol;
+
+	struct addrinfo * list = NULL;
+	struct addrinfo * copy = NULL;
+	if( refresh->_lookup( key->_host, key->_port, &hints, &list ) == 0 ) {
+		copy = _ts_resolver_copy( list );
+		refresh->_release( list );
+	}
+
+	pthread_mutex_lock( &_resolver_mutex );
+	TsResolverEntry_t * entry = _ts_resolver_find( key->_host, key->_port, &hints );
+	if( entry == NULL ) {
+		// flushed or replaced meanwhile
+		if( copy != NULL ) {
+			_ts_resolver_free( copy );
+		}
+	} else if( copy == NULL ) {
+		// keep serving the stale resolution, try again once the negative ttl (or the ttl when
+		// failures are not cached) passed, so that an outage of the name server does not
+		// start a refresh on every resolve
+		ts_status_debug( "ts_resolver: refresh of %s failed\n", key->_host );
+		uint32_t retry = ( _resolver_config._negative_ttl > 0 ) ? _resolver_config._negative_ttl : _resolver_config._ttl;
+		entry->_retry = ts_platform_time() + (uint64_t) retry * TS_TIME_SEC_TO_USEC;
+		entry->_refreshing = false;
+	} else {
+		_ts_resolver_store( key->_host, key->_port, &hints, copy, ts_platform_time() );
+	}
+	pthread_mutex_unlock( &_resolver_mutex );
+
+	ts_platform_free( refresh, sizeof( TsResolverRefresh_t ));
+	return NULL;
+}
+
+/**
+ * Start a background refresh of the given entry, called with the mutex held.
+ */
+static void _ts_resolver_refresh( TsResolverEntry_t * entry ) {
+
+	TsResolverRefresh_t * refresh = (TsResolverRefresh_t *) ts_platform_malloc( sizeof( TsResolverRefresh_t ));
+	if( refresh == NULL ) {
+		return;
+	}
+	refresh->_key = *entry;
+	refresh->_key._list = NULL;
+	refresh->_lookup = _resolver_config._lookup;
+	refresh->_release = _resolver_config._release;
+
+	pthread_t thread;
+	if( pthread_create( &thread, NULL, _ts_resolver_thread, refresh ) == 0 ) {
+		pthread_detach( thread );
+		entry->_refreshing = true;
+	} else {
+		ts_status_debug( "ts_resolver: cannot start refresh thread\n" );
+		ts_platform_free( refresh, sizeof( TsResolverRefresh_t ));
+	}
+}
+
+TsStatus_t ts_resolver_configure( const TsResolverConfig_t * config ) {
+
+	ts_status_trace( "ts_resolver_configure\n" );
+	ts_platform_assert( config != NULL );
+
+	// a list is released by the function that matches its lookup
+	if(( config->_lookup == NULL ) != ( config->_release == NULL )) {
+		ts_status_debug( "ts_resolver_configure: lookup and release must be replaced together\n" );
+		return TsStatusErrorBadRequest;
+	}
+
+	pthread_mutex_lock( &_resolver_mutex );
+	_resolver_config = *config;
+	if( _resolver_config._lookup == NULL ) {
+		_resolver_config._lookup = _ts_resolver_lookup;
+		_resolver_config._release = _ts_resolver_release;
+	}
+	pthread_mutex_unlock( &_resolver_mutex );
+
+	ts_resolver_flush();
+	return TsStatusOk;
+}
+
+TsStatus_t ts_resolver_resolve( const char * host, const char * port, const struct addrinfo * hints, struct addrinfo ** result ) {
+
+	ts_status_trace( "ts_resolver_resolve\n" );
+	ts_platform_assert( host != NULL );
+	ts_platform_assert( port != NULL );
+	ts_platform_assert( hints != NULL );
+	ts_platform_assert( result != NULL );
+
+	*result = NULL;
+	uint64_t now = ts_platform_time();
+
+	pthread_mutex_lock( &_resolver_mutex );
+	TsResolverLookup_t lookup = _resolver_config._lookup != NULL ? _resolver_config._lookup : _ts_resolver_lookup;
+	TsResolverRelease_t release = _resolver_config._release != NULL ? _resolver_config._release : _ts_resolver_release;
+	bool caching = _resolver_config._ttl > 0 &&
+		strlen( host ) < TS_RESOLVER_MAX_HOST_SIZE && strlen( port ) < TS_RESOLVER_MAX_PORT_SIZE;
+
+	TsResolverEntry_t * entry = caching ? _ts_resolver_find( host, port, hints ) : NULL;
+	if( entry != NULL ) {
+		uint64_t stale = entry->_expires + (uint64_t) _resolver_config._stale * TS_TIME_SEC_TO_USEC;
+		bool usable = now < entry->_expires || ( entry->_list != NULL && now < stale );
+		if( usable ) {
+			if( now >= entry->_expires && now >= entry->_retry && !entry->_refreshing ) {
+				_ts_resolver_refresh( entry );
+			}
+			entry->_used = now;
+			TsStatus_t status = TsStatusErrorNotFound;
+			if( entry->_list != NULL ) {
+				*result = _ts_resolver_copy( entry->_list );
+				status = ( *result != NULL ) ? TsStatusOk : TsStatusErrorInternalServerError;
+			}
+			pthread_mutex_unlock( &_resolver_mutex );
+			return status;
+		}
+	}
+	pthread_mutex_unlock( &_resolver_mutex );
+
+	// miss (or expired beyond use), resolve on the calling thread
+	struct addrinfo * list = NULL;
+	struct addrinfo * copy = NULL;
+	if( lookup( host, port, hints, &list ) == 0 ) {
+		copy = _ts_resolver_copy( list );
+		release( list );
+		if( copy == NULL ) {
+			return TsStatusErrorInternalServerError;
+		}
+	}
+
+	// the cache keeps its own copy, nothing is stored when that copy cannot be made
+	// (rather than remembering the host as unresolvable)
+	struct addrinfo * cached = ( caching && copy != NULL ) ? _ts_resolver_copy( copy ) : NULL;
+	if( caching && ( copy == NULL || cached != NULL )) {
+		pthread_mutex_lock( &_resolver_mutex );
+		_ts_resolver_store( host, port, hints, cached, ts_platform_time() );
+		pthread_mutex_unlock( &_resolver_mutex );
+	}
+
+	*result = copy;
+	return ( copy != NULL ) ? TsStatusOk : TsStatusErrorNotFound;
+}
+
+void ts_resolver_release( struct addrinfo * result ) {
+
+	if( result != NULL ) {
+		_ts_resolver_free( result );
+	}
+}
+
+void ts_resolver_flush() {
+
+	pthread_mutex_lock( &_resolver_mutex );
+	for( int i = 0; i < TS_RESOLVER_ENTRIES; i++ ) {
+		TsResolverEntry_t * entry = &( _resolver_entries[ i ] );
+		if( entry->_valid && entry->_list != NULL ) {
+			_ts_resolver_free( entry->_list );
+		}
+		entry->_list = NULL;
+		entry->_valid = false;
+		entry->_refreshing = false;
+	}
+	pthread_mutex_unlock( &_resolver_mutex );
+}
+
+#endif // TS_DRIVER_SOCKET
@@ -0,0 +1,83 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#ifndef TS_RESOLVER_H
+#define TS_RESOLVER_H
+
+#include <netdb.h>
+#include <stdint.h>
+
+#include "ts_platform.h"
+
+#ifndef TS_RESOLVER_ENTRIES
+#define TS_RESOLVER_ENTRIES 16
+#endif
+#define TS_RESOLVER_MAX_HOST_SIZE 256
+#define TS_RESOLVER_MAX_PORT_SIZE 16
+
+/**
+ * The lookup and release functions of the resolver, getaddrinfo and freeaddrinfo unless
+ * replaced, e.g., with a local stub in order to test without a name server. They are replaced
+ * together, a configuration with only one of them is rejected.
+ */
+typedef int (*TsResolverLookup_t)( const char * host, const char * port, const struct addrinfo * hints, struct addrinfo ** result );
+typedef void (*TsResolverRelease_t)( struct addrinfo * result );
+
+/**
+ * Resolver cache settings. Times are in seconds, a zero ttl disables the cache
+ * (the default), every resolve then calls the lookup function.
+ */
+typedef struct TsResolverConfig {
+
+	uint32_t _ttl;                  // how long a resolution is used without asking again
+	uint32_t _stale;                // how long past the ttl it is still used while it is refreshed in the background
+	uint32_t _negative_ttl;         // how long a failed resolution is remembered, and a failed refresh not retried
+	TsResolverLookup_t _lookup;     // NULL for getaddrinfo, only with a NULL _release
+	TsResolverRelease_t _release;   // NULL for freeaddrinfo, only with a NULL _lookup
+
+} TsResolverConfig_t;
+
+/**
+ * Configure the resolver cache, cached resolutions are dropped.
+ *
+ * @param config
+ * [in] The settings, copied.
+ *
+ * @return
+ * TsStatusOk              - The settings are in effect
+ * TsStatusErrorBadRequest - Only one of _lookup and _release was given, nothing was changed
+ */
+TsStatus_t ts_resolver_configure( const TsResolverConfig_t * config );
+
+/**
+ * Resolve the given host and port, from the cache when possible. A fresh resolution is
+ * returned as is; a stale one is returned while a background thread refreshes it, so that
+ * a reconnect storm neither blocks on nor floods the name server.
+ *
+ * @param host
+ * [in] The host name or address.
+ *
+ * @param port
+ * [in] The port (service).
+ *
+ * @param hints
+ * [in] As for getaddrinfo, the family, socket type and protocol are part of the cache key.
+ *
+ * @param result
+ * [out] A private copy of the address list, release it with ts_resolver_release.
+ *
+ * @return
+ * TsStatusOk            - The address list was returned
+ * TsStatusErrorNotFound - The host could not be resolved (possibly remembered)
+ */
+TsStatus_t ts_resolver_resolve( const char * host, const char * port, const struct addrinfo * hints, struct addrinfo ** result );
+
+/**
+ * Release an address list returned by ts_resolver_resolve.
+ */
+void ts_resolver_release( struct addrinfo * result );
+
+/**
+ * Drop all cached resolutions, e.g., after the network changed.
+ */
+void ts_resolver_flush();
+
+#endif // TS_RESOLVER_H
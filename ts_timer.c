@@ -0,0 +1,281 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#if defined(TS_TIMER_CUSTOM)
+#include <memory.h>
+#include <stdbool.h>
+
+#include "ts_platform.h"
+#include "ts_timer.h"
+
+// hierarchical timing wheel
+//
+// four levels of 64 slots. level 0 holds timers due within the next 64 ticks,
+// one slot per tick; each higher level covers 64 times the range of the one
+// below. whenever level 0 wraps, the next slot of level 1 is cascaded, i.e.,
+// its timers are re-inserted relative to the current tick, and so on upwards.
+// timers further out than the wheel covers wait in the last level and are
+// re-inserted each time they cascade.
+
+#ifndef TS_TIMER_RESOLUTION
+#define TS_TIMER_RESOLUTION 1000 // microseconds per tick
+#endif
+#define TS_TIMER_LEVELS 4
+#define TS_TIMER_BITS 6
+#define TS_TIMER_SLOTS ( 1 << TS_TIMER_BITS )
+#define TS_TIMER_MASK ( TS_TIMER_SLOTS - 1 )
+#define TS_TIMER_RANGE ( ( (uint64_t) 1 << ( TS_TIMER_BITS * TS_TIMER_LEVELS )) - 1 )
+
+typedef struct TsTimerWheel {
+
+	uint64_t _now;    // the next tick to process
+	size_t _count;
+	TsTimer_t _slots[ TS_TIMER_LEVELS ][ TS_TIMER_SLOTS ];   // list heads
+
+} TsTimerWheel_t;
+
+static TsStatus_t ts_create( TsTimerWheelRef_t * );
+static TsStatus_t ts_destroy( TsTimerWheelRef_t );
+static TsStatus_t ts_tick( TsTimerWheelRef_t, uint32_t );
+static TsStatus_t ts_arm( TsTimerWheelRef_t, TsTimerRef_t, uint32_t, TsTimerCallback_t, void * );
+static TsStatus_t ts_cancel( TsTimerWheelRef_t, TsTimerRef_t );
+static TsStatus_t ts_next( TsTimerWheelRef_t, uint32_t * );
+
+static TsTimerVtable_t ts_timer_unix = {
+	.create = ts_create,
+	.destroy = ts_destroy,
+	.tick = ts_tick,
+	.arm = ts_arm,
+	.cancel = ts_cancel,
+	.next = ts_next,
+};
+const TsTimerVtable_t * ts_timer = &(ts_timer_unix);
+
+static uint64_t _ts_timer_ticks() {
+	return ts_platform_time() / TS_TIMER_RESOLUTION;
+}
+
+static void _ts_timer_link( TsTimerRef_t head, TsTimerRef_t timer ) {
+
+	timer->_prev = head->_prev;
+	timer->_next = head;
+	head->_prev->_next = timer;
+	head->_prev = timer;
+}
+
+static void _ts_timer_unlink( TsTimerRef_t timer ) {
+
+	timer->_prev->_next = timer->_next;
+	timer->_next->_prev = timer->_prev;
+	timer->_next = NULL;
+	timer->_prev = NULL;
+}
+
+static void _ts_timer_insert( TsTimerWheelRef_t wheel, TsTimerRef_t timer ) {
+
+	uint64_t expires = timer->_expires;
+	if( expires < wheel->_now ) {
+		// already due, fire on the next processed tick
+		expires = wheel->_now;
+	} else if( expires - wheel->_now > TS_TIMER_RANGE ) {
+		// beyond the wheel, park in the last level until it cascades
+		expires = wheel->_now + TS_TIMER_RANGE;
+	}
+
+	uint64_t delta = expires - wheel->_now;
+	int level = 0;
+	while( level < TS_TIMER_LEVELS - 1 && delta >= ( (uint64_t) 1 << ( TS_TIMER_BITS * ( level + 1 )))) {
+		level = level + 1;
+	}
+	size_t slot = (size_t) ( expires >> ( TS_TIMER_BITS * level )) & TS_TIMER_MASK;
+	_ts_timer_link( &( wheel->_slots[ level ][ slot ] ), timer );
+}
+
+static size_t _ts_timer_cascade( TsTimerWheelRef_t wheel, int level ) {
+
+	size_t slot = (size_t) ( wheel->_now >> ( TS_TIMER_BITS * level )) & TS_TIMER_MASK;
+	TsTimerRef_t head = &( wheel->_slots[ level ][ slot ] );
+	while( head->_next != head ) {
+		TsTimerRef_t timer = head->_next;
+		_ts_timer_unlink( timer );
+		_ts_timer_insert( wheel, timer );
+	}
+	return slot;
+}
+
+static TsStatus_t ts_create( TsTimerWheelRef_t * wheel ) {
+
+	ts_status_trace( "ts_timer_create\n" );
+	ts_platform_assert( wheel != NULL );
+
+	*wheel = (TsTimerWheelRef_t) ts_platform_malloc( sizeof( TsTimerWheel_t ));
+	if( *wheel == NULL ) {
+		return TsStatusErrorInternalServerError;
+	}
+	for( int level = 0; level < TS_TIMER_LEVELS; level++ ) {
+		for( int slot = 0; slot < TS_TIMER_SLOTS; slot++ ) {
+			TsTimerRef_t head = &( (*wheel)->_slots[ level ][ slot ] );
+			head->_next = head;
+			head->_prev = head;
+		}
+	}
+	(*wheel)->_now = _ts_timer_ticks();
+	(*wheel)->_count = 0;
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_destroy( TsTimerWheelRef_t wheel ) {
+
+	ts_status_trace( "ts_timer_destroy\n" );
+	ts_platform_assert( wheel != NULL );
+
+	// detach remaining timers so their owners see them as disarmed
+	for( int level = 0; level < TS_TIMER_LEVELS; level++ ) {
+		for( int slot = 0; slot < TS_TIMER_SLOTS; slot++ ) {
+			TsTimerRef_t head = &( wheel->_slots[ level ][ slot ] );
+			while( head->_next != head ) {
+				_ts_timer_unlink( head->_next );
+			}
+		}
+	}
+	ts_platform_free( wheel, sizeof( TsTimerWheel_t ));
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_tick( TsTimerWheelRef_t wheel, uint32_t budget ) {
+
+	ts_status_trace( "ts_timer_tick\n" );
+	ts_platform_assert( wheel != NULL );
+
+	uint64_t timestamp = ts_platform_time();
+	uint64_t target = timestamp / TS_TIMER_RESOLUTION;
+
+	if( wheel->_count == 0 ) {
+		// nothing to cascade or fire, skip the idle ticks
+		if( wheel->_now <= target ) {
+			wheel->_now = target + 1;
+		}
+		return TsStatusOk;
+	}
+
+	while( wheel->_now <= target ) {
+
+		size_t slot = (size_t) ( wheel->_now & TS_TIMER_MASK );
+		for( int level = 1; slot == 0 && level < TS_TIMER_LEVELS; level++ ) {
+			slot = _ts_timer_cascade( wheel, level );
+		}
+		slot = (size_t) ( wheel->_now & TS_TIMER_MASK );
+
+		// move the due timers aside so callbacks can safely re-arm into this slot
+		TsTimer_t expired;
+		TsTimerRef_t head = &( wheel->_slots[ 0 ][ slot ] );
+		expired._next = &expired;
+		expired._prev = &expired;
+		if( head->_next != head ) {
+			expired._next = head->_next;
+			expired._prev = head->_prev;
+			expired._next->_prev = &expired;
+			expired._prev->_next = &expired;
+			head->_next = head;
+			head->_prev = head;
+		}
+		wheel->_now = wheel->_now + 1;
+
+		while( expired._next != &expired ) {
+			TsTimerRef_t timer = expired._next;
+			_ts_timer_unlink( timer );
+			wheel->_count = wheel->_count - 1;
+			timer->_callback( timer, timer->_state );
+		}
+
+		if( ts_platform_time() - timestamp > budget ) {
+			// remaining ticks are caught up on the next call
+			ts_status_debug( "ts_timer_tick: timer budget exceeded\n" );
+			break;
+		}
+	}
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_arm( TsTimerWheelRef_t wheel, TsTimerRef_t timer, uint32_t delay, TsTimerCallback_t callback, void * state ) {
+
+	ts_platform_assert( wheel != NULL );
+	ts_platform_assert( timer != NULL );
+	ts_platform_assert( callback != NULL );
+
+	if( timer->_next != NULL ) {
+		ts_cancel( wheel, timer );
+	}
+	uint64_t now = _ts_timer_ticks();
+	if( wheel->_count == 0 && wheel->_now < now ) {
+		// an idle wheel is not ticked forward, skip the missed ticks rather than walk them
+		wheel->_now = now;
+	}
+	timer->_callback = callback;
+	timer->_state = state;
+	timer->_expires = now + ( (uint64_t) delay + TS_TIMER_RESOLUTION - 1 ) / TS_TIMER_RESOLUTION;
+	_ts_timer_insert( wheel, timer );
+	wheel->_count = wheel->_count + 1;
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_cancel( TsTimerWheelRef_t wheel, TsTimerRef_t timer ) {
+
+	ts_platform_assert( wheel != NULL );
+	ts_platform_assert( timer != NULL );
+
+	if( timer->_next != NULL ) {
+		_ts_timer_unlink( timer );
+		wheel->_count = wheel->_count - 1;
+	}
+	return TsStatusOk;
+}
+
+/**
+ * Until level 0 wraps nothing cascades into it, so the first occupied level 0 slot
+ * before the wrap is the answer. Otherwise the earliest expiry is found by walking
+ * every occupied slot, which is proportional to the number of armed timers but only
+ * happens when nothing is due before the wrap.
+ */
+static TsStatus_t ts_next( TsTimerWheelRef_t wheel, uint32_t * delay ) {
+
+	ts_platform_assert( wheel != NULL );
+	ts_platform_assert( delay != NULL );
+
+	*delay = UINT32_MAX;
+	if( wheel->_count == 0 ) {
+		return TsStatusOk;
+	}
+
+	bool found = false;
+	uint64_t earliest = UINT64_MAX;
+	for( uint64_t tick = wheel->_now; tick <= ( wheel->_now | TS_TIMER_MASK ); tick++ ) {
+		TsTimerRef_t head = &( wheel->_slots[ 0 ][ tick & TS_TIMER_MASK ] );
+		if( head->_next != head ) {
+			earliest = tick;
+			found = true;
+			break;
+		}
+	}
+	for( int level = 0; !found && level < TS_TIMER_LEVELS; level++ ) {
+		for( int slot = 0; slot < TS_TIMER_SLOTS; slot++ ) {
+			TsTimerRef_t head = &( wheel->_slots[ level ][ slot ] );
+			for( TsTimerRef_t timer = head->_next; timer != head; timer = timer->_next ) {
+				if( timer->_expires < earliest ) {
+					earliest = timer->_expires;
+				}
+			}
+		}
+	}
+
+	uint64_t now = _ts_timer_ticks();
+	if( earliest <= now ) {
+		*delay = 0;
+	} else if(( earliest - now ) * TS_TIMER_RESOLUTION < UINT32_MAX ) {
+		*delay = (uint32_t) (( earliest - now ) * TS_TIMER_RESOLUTION );
+	}
+	return TsStatusOk;
+}
+
+#endif // TS_TIMER_CUSTOM
@@ -0,0 +1,77 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#ifndef TS_TIMER_H
+#define TS_TIMER_H
+
+#include <stdint.h>
+
+#include "ts_platform.h"
+
+typedef struct TsTimer * TsTimerRef_t;
+typedef struct TsTimerWheel * TsTimerWheelRef_t;
+typedef void (*TsTimerCallback_t)( TsTimerRef_t, void * );
+
+/**
+ * A timer, owned by the caller. The wheel links timers in place, so arming and
+ * cancelling never allocate. A timer must be cancelled or have fired before its
+ * memory is released.
+ */
+typedef struct TsTimer {
+
+	struct TsTimer * _next;
+	struct TsTimer * _prev;
+	uint64_t _expires;
+	TsTimerCallback_t _callback;
+	void * _state;
+
+} TsTimer_t;
+
+#define TS_TIMER_INITIALIZER { NULL, NULL, 0, NULL, NULL }
+
+typedef struct TsTimerVtable {
+
+	/**
+	 * Allocate and initialize a timer wheel. The wheel is not thread safe, arm, cancel
+	 * and tick it from the thread that services the sdk.
+	 */
+	TsStatus_t (*create)( TsTimerWheelRef_t * );
+
+	/**
+	 * Deallocate the given timer wheel, armed timers are forgotten without firing.
+	 */
+	TsStatus_t (*destroy)( TsTimerWheelRef_t );
+
+	/**
+	 * Fire every timer that is due, in order of expiry. Callbacks run on the calling
+	 * thread and may arm or cancel timers, including the one firing.
+	 */
+	TsStatus_t (*tick)( TsTimerWheelRef_t, uint32_t budget );
+
+	/**
+	 * Arm (or re-arm) the given timer to fire once after the given delay in microseconds,
+	 * rounded up to the wheel resolution. O(1).
+	 */
+	TsStatus_t (*arm)( TsTimerWheelRef_t, TsTimerRef_t, uint32_t delay, TsTimerCallback_t, void * );
+
+	/**
+	 * Cancel the given timer, cancelling a timer that is not armed does nothing. O(1).
+	 */
+	TsStatus_t (*cancel)( TsTimerWheelRef_t, TsTimerRef_t );
+
+	/**
+	 * Return the time in microseconds until the next timer is due, UINT32_MAX when no
+	 * timer is armed. Callers use this to sleep until there is work rather than poll.
+	 */
+	TsStatus_t (*next)( TsTimerWheelRef_t, uint32_t * delay );
+
+} TsTimerVtable_t;
+
+extern const TsTimerVtable_t * ts_timer;
+
+#define ts_timer_create(wheel) ts_timer->create(wheel)
+#define ts_timer_destroy(wheel) ts_timer->destroy(wheel)
+#define ts_timer_tick(wheel, budget) ts_timer->tick(wheel, budget)
+#define ts_timer_arm(wheel, timer, delay, callback, state) ts_timer->arm(wheel, timer, delay, callback, state)
+#define ts_timer_cancel(wheel, timer) ts_timer->cancel(wheel, timer)
+#define ts_timer_next(wheel, delay) ts_timer->next(wheel, delay)
+
+#endif // TS_TIMER_H
@@ -0,0 +1,280 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#if defined(TS_WAIT_CUSTOM)
+#if defined(__linux__)
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "ts_platform.h"
+#include "ts_timer.h"
+#include "ts_wait.h"
+
+// epoll based wait set
+//
+// the service loop blocks in epoll_wait until a driver descriptor is ready or
+// a timerfd armed for the nearest deadline (timer wheel or budget) expires,
+// instead of repeatedly polling drivers that have nothing to read. the timerfd
+// gives microsecond deadlines where the epoll_wait timeout has milliseconds.
+
+#ifndef TS_WAIT_MAX_FDS
+#define TS_WAIT_MAX_FDS 16
+#endif
+
+typedef struct TsWaitEntry {
+	int _fd;
+	uint32_t _events;
+	TsWaitHandler_t _handler;
+	void * _state;
+} TsWaitEntry_t;
+
+typedef struct TsWait {
+
+	int _epoll_fd;
+	int _timer_fd;
+	TsWaitEntry_t _entries[ TS_WAIT_MAX_FDS ];
+
+} TsWait_t;
+
+static TsStatus_t ts_create( TsWaitRef_t * );
+static TsStatus_t ts_destroy( TsWaitRef_t );
+static TsStatus_t ts_add( TsWaitRef_t, int, uint32_t, TsWaitHandler_t, void * );
+static TsStatus_t ts_modify( TsWaitRef_t, int, uint32_t );
+static TsStatus_t ts_remove( TsWaitRef_t, int );
+static TsStatus_t ts_wait_for( TsWaitRef_t, TsTimerWheelRef_t, uint32_t );
+
+static TsWaitVtable_t ts_wait_unix = {
+	.create = ts_create,
+	.destroy = ts_destroy,
+	.add = ts_add,
+	.modify = ts_modify,
+	.remove = ts_remove,
+	.wait = ts_wait_for,
+};
+const TsWaitVtable_t * ts_wait = &(ts_wait_unix);
+
+static uint32_t _ts_wait_to_epoll( uint32_t events ) {
+
+	uint32_t result = 0;
+	if( events & TS_WAIT_READABLE ) {
+		result = result | EPOLLIN;
+	}
+	if( events & TS_WAIT_WRITABLE ) {
+		result = result | EPOLLOUT;
+	}
+	return result;
+}
+
+static uint32_t _ts_wait_from_epoll( uint32_t events ) {
+
+	uint32_t result = 0;
+	if( events & ( EPOLLIN | EPOLLRDHUP )) {
+		result = result | TS_WAIT_READABLE;
+	}
+	if( events & EPOLLOUT ) {
+		result = result | TS_WAIT_WRITABLE;
+	}
+	if( events & ( EPOLLERR | EPOLLHUP )) {
+		result = result | TS_WAIT_ERROR;
+	}
+	return result;
+}
+
+static TsWaitEntry_t * _ts_wait_find( TsWaitRef_t wait, int fd ) {
+
+	for( int index = 0; index < TS_WAIT_MAX_FDS; index++ ) {
+		if( wait->_entries[ index ]._fd == fd ) {
+			return &( wait->_entries[ index ] );
+		}
+	}
+	return NULL;
+}
+
+static TsStatus_t ts_create( TsWaitRef_t * wait ) {
+
+	ts_status_trace( "ts_wait_create\n" );
+	ts_platform_assert( wait != NULL );
+
+	TsWaitRef_t epoll = (TsWaitRef_t) ts_platform_malloc( sizeof( TsWait_t ));
+	if( epoll == NULL ) {
+		return TsStatusErrorInternalServerError;
+	}
+	for( int index = 0; index < TS_WAIT_MAX_FDS; index++ ) {
+		epoll->_entries[ index ]._fd = -1;
+	}
+
+	epoll->_epoll_fd = epoll_create1( EPOLL_CLOEXEC );
+	epoll->_timer_fd = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC );
+	if( epoll->_epoll_fd < 0 || epoll->_timer_fd < 0 ) {
+		ts_status_alarm( "ts_wait_create: failed, %s\n", strerror( errno ));
+		if( epoll->_epoll_fd >= 0 ) {
+			close( epoll->_epoll_fd );
+		}
+		if( epoll->_timer_fd >= 0 ) {
+			close( epoll->_timer_fd );
+		}
+		ts_platform_free( epoll, sizeof( TsWait_t ));
+		return TsStatusErrorInternalServerError;
+	}
+
+	// the timer is told apart from the entries by a null data pointer
+	struct epoll_event event;
+	memset( &event, 0x00, sizeof( event ));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	epoll_ctl( epoll->_epoll_fd, EPOLL_CTL_ADD, epoll->_timer_fd, &event );
+
+	*wait = epoll;
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_destroy( TsWaitRef_t wait ) {
+
+	ts_status_trace( "ts_wait_destroy\n" );
+	ts_platform_assert( wait != NULL );
+
+	close( wait->_timer_fd );
+	close( wait->_epoll_fd );
+	ts_platform_free( wait, sizeof( TsWait_t ));
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_add( TsWaitRef_t wait, int fd, uint32_t events, TsWaitHandler_t handler, void * state ) {
+
+	ts_platform_assert( wait != NULL );
+	ts_platform_assert( handler != NULL );
+
+	if( fd < 0 ) {
+		return TsStatusErrorBadRequest;
+	}
+	TsWaitEntry_t * entry = _ts_wait_find( wait, -1 );
+	if( entry == NULL ) {
+		ts_status_alarm( "ts_wait_add: too many descriptors, increase TS_WAIT_MAX_FDS\n" );
+		return TsStatusErrorInternalServerError;
+	}
+
+	struct epoll_event event;
+	memset( &event, 0x00, sizeof( event ));
+	event.events = _ts_wait_to_epoll( events );
+	event.data.ptr = entry;
+	if( epoll_ctl( wait->_epoll_fd, EPOLL_CTL_ADD, fd, &event ) < 0 ) {
+		ts_status_alarm( "ts_wait_add: failed, %s\n", strerror( errno ));
+		return TsStatusErrorInternalServerError;
+	}
+	entry->_fd = fd;
+	entry->_events = events;
+	entry->_handler = handler;
+	entry->_state = state;
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_modify( TsWaitRef_t wait, int fd, uint32_t events ) {
+
+	ts_platform_assert( wait != NULL );
+
+	TsWaitEntry_t * entry = _ts_wait_find( wait, fd );
+	if( fd < 0 || entry == NULL ) {
+		return TsStatusErrorNotFound;
+	}
+	if( entry->_events == events ) {
+		return TsStatusOk;
+	}
+
+	struct epoll_event event;
+	memset( &event, 0x00, sizeof( event ));
+	event.events = _ts_wait_to_epoll( events );
+	event.data.ptr = entry;
+	if( epoll_ctl( wait->_epoll_fd, EPOLL_CTL_MOD, fd, &event ) < 0 ) {
+		ts_status_alarm( "ts_wait_modify: failed, %s\n", strerror( errno ));
+		return TsStatusErrorInternalServerError;
+	}
+	entry->_events = events;
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_remove( TsWaitRef_t wait, int fd ) {
+
+	ts_platform_assert( wait != NULL );
+
+	TsWaitEntry_t * entry = _ts_wait_find( wait, fd );
+	if( fd < 0 || entry == NULL ) {
+		return TsStatusErrorNotFound;
+	}
+	epoll_ctl( wait->_epoll_fd, EPOLL_CTL_DEL, fd, NULL );
+	entry->_fd = -1;
+	entry->_handler = NULL;
+
+	return TsStatusOk;
+}
+
+static TsStatus_t ts_wait_for( TsWaitRef_t wait, TsTimerWheelRef_t timers, uint32_t budget ) {
+
+	ts_status_trace( "ts_wait_wait\n" );
+	ts_platform_assert( wait != NULL );
+
+	// sleep no longer than the budget or the next timer, whichever is sooner
+	uint32_t timeout = budget;
+#if defined(TS_TIMER_CUSTOM)
+	if( timers != NULL ) {
+		uint32_t next;
+		ts_timer_next( timers, &next );
+		if( next < timeout ) {
+			timeout = next;
+		}
+	}
+#endif
+
+	int milliseconds = 0;
+	if( timeout > 0 ) {
+		struct itimerspec deadline;
+		memset( &deadline, 0x00, sizeof( deadline ));
+		deadline.it_value.tv_sec = timeout / TS_TIME_SEC_TO_USEC;
+		deadline.it_value.tv_nsec = ( timeout % TS_TIME_SEC_TO_USEC ) * TS_TIME_USEC_TO_NSEC;
+		timerfd_settime( wait->_timer_fd, 0, &deadline, NULL );
+		milliseconds = -1;
+	}
+
+	struct epoll_event events[ TS_WAIT_MAX_FDS + 1 ];
+	int count = epoll_wait( wait->_epoll_fd, events, TS_WAIT_MAX_FDS + 1, milliseconds );
+	if( count < 0 && errno != EINTR ) {
+		ts_status_alarm( "ts_wait_wait: failed, %s\n", strerror( errno ));
+		return TsStatusErrorInternalServerError;
+	}
+
+	for( int index = 0; index < count; index++ ) {
+
+		TsWaitEntry_t * entry = (TsWaitEntry_t *) events[ index ].data.ptr;
+		if( entry == NULL ) {
+			// deadline reached, clear the expiration count
+			uint64_t expirations;
+			ssize_t size = read( wait->_timer_fd, &expirations, sizeof( expirations ));
+			(void) size;
+			continue;
+		}
+		// an earlier handler in this batch may have removed the descriptor
+		if( entry->_fd >= 0 && entry->_handler != NULL ) {
+			entry->_handler( wait, entry->_fd, _ts_wait_from_epoll( events[ index ].events ), entry->_state );
+		}
+	}
+
+	// disarm, a descriptor may have woken us before the deadline
+	if( milliseconds < 0 ) {
+		struct itimerspec disarm;
+		memset( &disarm, 0x00, sizeof( disarm ));
+		timerfd_settime( wait->_timer_fd, 0, &disarm, NULL );
+	}
+
+#if defined(TS_TIMER_CUSTOM)
+	if( timers != NULL ) {
+		ts_timer_tick( timers, budget );
+	}
+#endif
+	return TsStatusOk;
+}
+
+#endif // __linux__
+#endif // TS_WAIT_CUSTOM
@@ -0,0 +1,64 @@
+// Copyright (C) 2017, 2018 Verizon, Inc. All rights reserved.
+#ifndef TS_WAIT_H
+#define TS_WAIT_H
+
+#include <stdint.h>
+
+#include "ts_platform.h"
+#include "ts_timer.h"
+
+#define TS_WAIT_READABLE 0x01
+#define TS_WAIT_WRITABLE 0x02
+#define TS_WAIT_ERROR    0x04   // reported only, hangup or error on the descriptor
+
+typedef struct TsWait * TsWaitRef_t;
+typedef void (*TsWaitHandler_t)( TsWaitRef_t, int fd, uint32_t events, void * state );
+
+typedef struct TsWaitVtable {
+
+	/**
+	 * Allocate and initialize a wait set.
+	 */
+	TsStatus_t (*create)( TsWaitRef_t * );
+
+	/**
+	 * Deallocate the given wait set, registered descriptors are not closed.
+	 */
+	TsStatus_t (*destroy)( TsWaitRef_t );
+
+	/**
+	 * Register a descriptor, e.g., from ts_driver_unix_fd, with the events (TS_WAIT_*)
+	 * to wait for and the handler to call when they occur.
+	 */
+	TsStatus_t (*add)( TsWaitRef_t, int fd, uint32_t events, TsWaitHandler_t handler, void * state );
+
+	/**
+	 * Change the events a registered descriptor waits for, e.g., add TS_WAIT_WRITABLE
+	 * only while a write is pending.
+	 */
+	TsStatus_t (*modify)( TsWaitRef_t, int fd, uint32_t events );
+
+	/**
+	 * Unregister a descriptor, must be called before the descriptor is closed.
+	 */
+	TsStatus_t (*remove)( TsWaitRef_t, int fd );
+
+	/**
+	 * Block until a registered descriptor is ready, the next timer of the given wheel
+	 * (may be NULL) is due, or the budget in microseconds expires, whichever is first.
+	 * Ready handlers are called and due timers fired before returning.
+	 */
+	TsStatus_t (*wait)( TsWaitRef_t, TsTimerWheelRef_t timers, uint32_t budget );
+
+} TsWaitVtable_t;
+
+extern const TsWaitVtable_t * ts_wait;
+
+#define ts_wait_create(set) ts_wait->create(set)
+#define ts_wait_destroy(set) ts_wait->destroy(set)
+#define ts_wait_add(set, fd, events, handler, state) ts_wait->add(set, fd, events, handler, state)
+#define ts_wait_modify(set, fd, events) ts_wait->modify(set, fd, events)
+#define ts_wait_remove(set, fd) ts_wait->remove(set, fd)
+#define ts_wait_wait(set, timers, budget) ts_wait->wait(set, timers, budget)
+
+#endif // TS_WAIT_H